@@ -0,0 +1,83 @@
+/** @file
+ * A blocking queue of bounded capacity, for handing work from producer threads to consumer threads.
+ * Used to overlap read parsing with read mapping in quasimap.
+ */
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+
+#ifndef GRAMTOOLS_BOUNDED_QUEUE_HPP
+#define GRAMTOOLS_BOUNDED_QUEUE_HPP
+
+namespace gram {
+
+    /**
+     * Producers block in `push()` while the queue holds `capacity` elements; consumers block in `pop()` while it is empty.
+     * Once the queue is `close()`d, consumers drain the remaining elements and `pop()` then returns false,
+     * and further pushes are dropped.
+     */
+    template<typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(const uint64_t &capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+        BoundedQueue(const BoundedQueue &) = delete;
+
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        /**
+         * @return false if the queue has been closed; `element` is then dropped.
+         */
+        bool push(T element) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock, [this] { return elements.size() < capacity or closed; });
+            if (closed)
+                return false;
+            elements.push_back(std::move(element));
+            lock.unlock();
+            not_empty.notify_one();
+            return true;
+        }
+
+        /**
+         * Moves the next element into `element`.
+         * @return false if the queue is closed and empty; `element` is then left unchanged.
+         */
+        bool pop(T &element) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this] { return not elements.empty() or closed; });
+            if (elements.empty())
+                return false;
+            element = std::move(elements.front());
+            elements.pop_front();
+            lock.unlock();
+            not_full.notify_one();
+            return true;
+        }
+
+        /**
+         * Signals that no more elements will be pushed. Producers blocked in `push()` are released.
+         */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+    private:
+        const uint64_t capacity;
+        std::deque<T> elements;
+        bool closed = false;
+        std::mutex mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+
+}
+
+#endif //GRAMTOOLS_BOUNDED_QUEUE_HPP
@@ -0,0 +1,114 @@
+/** @file
+ * A buffered writer for large text outputs, optionally gzip compressed.
+ * Outputs are formatted straight into a fixed size buffer, which is flushed to the file whenever it fills up,
+ * so that serialising a large structure never holds the whole document in memory.
+ */
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+
+#ifndef GRAMTOOLS_BUFFERED_WRITER_HPP
+#define GRAMTOOLS_BUFFERED_WRITER_HPP
+
+namespace gram {
+
+    enum class OutputCompression {
+        none,
+        gzip
+    };
+
+    /**
+     * @return `fpath`, with the extension of the compression appended.
+     */
+    std::string compressed_fpath(const std::string &fpath, const OutputCompression &compression);
+
+    class BufferedWriter {
+    public:
+        /**
+         * Opens `fpath` for writing. Exits if the file cannot be opened.
+         */
+        BufferedWriter(const std::string &fpath, const OutputCompression &compression);
+
+        /**
+         * Appends all output to `destination` rather than to a file.
+         */
+        explicit BufferedWriter(std::string &destination);
+
+        /**
+         * Flushes the buffer and closes the file.
+         */
+        ~BufferedWriter();
+
+        BufferedWriter(const BufferedWriter &) = delete;
+
+        BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+        void write(const char *data, const uint64_t &size) {
+            if (size > buffer.size() - used) {
+                flush();
+                if (size > buffer.size()) {
+                    write_out(data, size);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+
+        BufferedWriter &operator<<(const char &character) {
+            if (used == buffer.size())
+                flush();
+            buffer[used++] = character;
+            return *this;
+        }
+
+        BufferedWriter &operator<<(const char *text) {
+            write(text, std::strlen(text));
+            return *this;
+        }
+
+        BufferedWriter &operator<<(const std::string &text) {
+            write(text.data(), text.size());
+            return *this;
+        }
+
+        /**
+         * Formats an integer in decimal, without going through a stream or a temporary string.
+         */
+        template<typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value
+                                                               and not std::is_same<Integer, char>::value
+                                                               and not std::is_same<Integer, bool>::value>>
+        BufferedWriter &operator<<(const Integer &value) {
+            // Large enough for any 64 bit integer, with its sign.
+            constexpr uint64_t max_digits = 20;
+            if (buffer.size() - used < max_digits)
+                flush();
+            auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+            used = result.ptr - buffer.data();
+            return *this;
+        }
+
+        /**
+         * Writes the buffered output out.
+         */
+        void flush();
+
+    private:
+        std::string fpath;
+        std::FILE *file = nullptr;
+        gzFile compressed_file = nullptr;
+        std::string *destination = nullptr;
+        std::vector<char> buffer;
+        uint64_t used = 0;
+
+        void write_out(const char *data, const uint64_t &size);
+    };
+
+}
+
+#endif //GRAMTOOLS_BUFFERED_WRITER_HPP
@@ -0,0 +1,64 @@
+/** @file
+ * Decompresses read files on background threads, so that parsing reads is not limited by single-threaded inflation.
+ * BGZF files are decompressed block-parallel by htslib; plain gzip files are inflated on a dedicated thread.
+ * The decompressed bytes are written to a pipe, whose read end is parsed as an uncompressed file.
+ */
+#include <cstdint>
+#include <string>
+#include <thread>
+
+
+#ifndef GRAMTOOLS_DECOMPRESSION_HPP
+#define GRAMTOOLS_DECOMPRESSION_HPP
+
+namespace gram {
+
+    enum class CompressionFormat {
+        none,
+        gzip,
+        bgzf /**< gzip members of at most 64KB, each with a 'BC' extra field giving its size. */
+    };
+
+    /**
+     * Identifies the compression of a file from its first bytes.
+     * Exits if the file cannot be opened.
+     */
+    CompressionFormat detect_compression_format(const std::string &fpath);
+
+    /**
+     * Decompresses a gzip or BGZF file into a pipe.
+     * The read end of the pipe is handed over with `release_read_descriptor()`; whoever reads it must read it to
+     * its end or close it, for the decompression to finish.
+     */
+    class DecompressionPipe {
+    public:
+        /**
+         * Starts decompressing `fpath` in the background. Exits if the file cannot be opened.
+         * @param count_threads threads used to decompress BGZF blocks in parallel. Plain gzip uses a single thread.
+         */
+        DecompressionPipe(const std::string &fpath,
+                          const CompressionFormat &compression_format,
+                          const uint32_t &count_threads);
+
+        /**
+         * Waits for the decompression to finish.
+         */
+        ~DecompressionPipe();
+
+        DecompressionPipe(const DecompressionPipe &) = delete;
+
+        DecompressionPipe &operator=(const DecompressionPipe &) = delete;
+
+        /**
+         * @return the read end of the pipe, which the caller now owns.
+         */
+        int release_read_descriptor();
+
+    private:
+        int read_descriptor = -1;
+        std::thread writer;
+    };
+
+}
+
+#endif //GRAMTOOLS_DECOMPRESSION_HPP
@@ -0,0 +1,159 @@
+/** @file
+ * Read-only memory mapping of files, and a vector which either owns its elements or views mapped ones.
+ * Used to load on-disk structures whose in-memory layout is their on-disk layout, without parsing.
+ */
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+#ifndef GRAMTOOLS_MEMORY_MAP_HPP
+#define GRAMTOOLS_MEMORY_MAP_HPP
+
+namespace gram {
+
+    /**
+     * A read-only, shared mapping of a whole file.
+     * Processes mapping the same file share its pages through the page cache.
+     */
+    class MemoryMap {
+    public:
+        explicit MemoryMap(const std::string &fpath);
+
+        ~MemoryMap();
+
+        MemoryMap(const MemoryMap &) = delete;
+
+        MemoryMap &operator=(const MemoryMap &) = delete;
+
+        const char *data() const { return address; }
+
+        uint64_t size() const { return length; }
+
+    private:
+        const char *address = nullptr;
+        uint64_t length = 0;
+    };
+
+    using MemoryMapPtr = std::shared_ptr<const MemoryMap>;
+
+    /**
+     * Maps the file at `fpath`. Exits if the file cannot be opened or mapped.
+     */
+    MemoryMapPtr map_file(const std::string &fpath);
+
+    /**
+     * Stream buffer reading from a region of memory, such as part of a `MemoryMap`.
+     * Lets structures with stream-based deserialisation (eg `sdsl`) load from mapped memory without going through a file.
+     */
+    class MemoryStreamBuffer : public std::streambuf {
+    public:
+        MemoryStreamBuffer(const char *data, const uint64_t &size) {
+            auto begin = const_cast<char *>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+
+    /**
+     * A contiguous array of trivially copyable elements, either owned (as a `std::vector`) or viewed in a `MemoryMap`.
+     * Read access is the same for both. A viewed array is copied into owned storage the first time it is modified,
+     * through `own()` or a member which resizes it.
+     */
+    template<typename T>
+    class MappedVector {
+    public:
+        using value_type = T;
+        using const_iterator = const T *;
+
+        MappedVector() = default;
+
+        MappedVector(std::initializer_list<T> elements) : owned(elements) {}
+
+        MappedVector(std::vector<T> elements) : owned(std::move(elements)) {}
+
+        /**
+         * Views `size` elements starting at `elements`, which must lie in `memory_map`.
+         */
+        static MappedVector view(const T *elements, const uint64_t &size, MemoryMapPtr memory_map) {
+            MappedVector mapped_vector;
+            mapped_vector.mapped_elements = elements;
+            mapped_vector.mapped_size = size;
+            mapped_vector.memory_map = std::move(memory_map);
+            return mapped_vector;
+        }
+
+        bool is_mapped() const { return memory_map != nullptr; }
+
+        const T *data() const { return is_mapped() ? mapped_elements : owned.data(); }
+
+        uint64_t size() const { return is_mapped() ? mapped_size : owned.size(); }
+
+        bool empty() const { return size() == 0; }
+
+        const T &operator[](const uint64_t &i) const { return data()[i]; }
+
+        const_iterator begin() const { return data(); }
+
+        const_iterator end() const { return data() + size(); }
+
+        const T &back() const { return data()[size() - 1]; }
+
+        void reserve(const uint64_t &size) { own().reserve(size); }
+
+        void resize(const uint64_t &size) { own().resize(size); }
+
+        void assign(const uint64_t &size, const T &value) {
+            release();
+            owned.assign(size, value);
+        }
+
+        void push_back(const T &element) { own().push_back(element); }
+
+        template<typename... Args>
+        void emplace_back(Args &&... args) { own().emplace_back(std::forward<Args>(args)...); }
+
+        template<typename InputIterator>
+        void insert_back(InputIterator first, InputIterator last) {
+            auto &elements = own();
+            elements.insert(elements.end(), first, last);
+        }
+
+        bool operator==(const MappedVector &other) const {
+            return size() == other.size() and std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const MappedVector &other) const { return not(*this == other); }
+
+        /**
+         * The owned elements, for modification. A viewed array is first copied out of its mapping, which is released:
+         * element access has no non-const overload so that this copy is never made implicitly.
+         */
+        std::vector<T> &own() {
+            if (is_mapped()) {
+                owned.assign(mapped_elements, mapped_elements + mapped_size);
+                release();
+            }
+            return owned;
+        }
+
+    private:
+        std::vector<T> owned;
+        const T *mapped_elements = nullptr;
+        uint64_t mapped_size = 0;
+        MemoryMapPtr memory_map;
+
+        void release() {
+            mapped_elements = nullptr;
+            mapped_size = 0;
+            memory_map.reset();
+        }
+    };
+
+}
+
+#endif //GRAMTOOLS_MEMORY_MAP_HPP
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "common/buffered_writer.hpp"
+
 
 #ifndef GRAMTOOLS_PARAMETERS_HPP
 #define GRAMTOOLS_PARAMETERS_HPP
@@ -12,7 +14,21 @@ namespace gram {
 
     enum class Commands {
         build,
-        quasimap
+        quasimap,
+        coverage_to_json
+    };
+
+    /**
+     * Width of the base-level coverage counters. Counters saturate at their maximum value.
+     */
+    enum class BaseCoverageWidth {
+        bits16,
+        bits32
+    };
+
+    enum class CoverageFormat {
+        json, /**< One file per coverage metric: allele sums as text, allele base and grouped allele counts as JSON. */
+        binary /**< All coverage metrics in one compact, indexed file. @see BinaryCoverageReader */
     };
 
     /**
@@ -31,6 +47,7 @@ namespace gram {
         std::string sites_mask_fpath;
         std::string allele_mask_fpath;
         std::string sdsl_memory_log_fpath;
+        std::string prg_info_bundle_fpath;
 
         // kmer index file paths
         std::string kmer_index_fpath;
@@ -42,6 +59,7 @@ namespace gram {
         uint32_t kmers_size;
         uint32_t max_read_size;
         bool all_kmers_flag;
+        uint32_t sa_sampling_interval = 1; /**< Suffix array values are kept for one in this many prg positions. */
 
         // quasimap specific parameters
         std::vector<std::string> reads_fpaths;
@@ -49,11 +67,18 @@ namespace gram {
         std::string allele_sum_coverage_fpath;
         std::string allele_base_coverage_fpath;
         std::string grouped_allele_counts_fpath;
+        std::string binary_coverage_fpath;
+        CoverageFormat coverage_format;
+        OutputCompression coverage_compression; /**< Compression of the text and JSON coverage files. */
+        BaseCoverageWidth base_coverage_width = BaseCoverageWidth::bits32; /**< Width of the base-level coverage counters. */
         
         std::string read_stats_fpath;
 
         uint32_t maximum_threads;
         uint32_t seed;
+        uint64_t reads_batch_size; /**< Number of reads parsed and mapped together. */
+        uint64_t reads_queue_depth; /**< Number of parsed read batches which can wait to be mapped. */
+        uint32_t decompression_threads; /**< Threads decompressing BGZF reads files. */
     };
 
 }
@@ -4,13 +4,12 @@
  *  This module allows for recording that, as well as some other usable metrics, such as max read length and number of
  *  sites with no coverage.
  */
+#include "sequence_read/seqread.hpp"
 #include "quasimap/coverage/types.hpp"
 
 #ifndef GRAMTOOLS_READSTATS_HPP
 #define GRAMTOOLS_READSTATS_HPP
 
-#define NUM_READS_USED 10000
-
 namespace gram {
 
     /**
@@ -19,20 +18,40 @@ namespace gram {
     class ReadStats {
     public:
         // Default constructor: -1 initialisation to signal that attribute has not been computed.
-        ReadStats() : mean_error(-1), no_qual_reads(-1), max_read_length(-1), num_bases_processed(-1),
+        // Read quality statistics are accumulated over reads, so they start from 0.
+        ReadStats() : mean_error(-1), no_qual_reads(0), max_read_length(0), num_bases_processed(0),
                         mean_depth(-1), variance_depth(-1), num_sites_noCov(-1), num_sites_total(-1) {};
 
         /**
-         * Compute probability of erroneous base from base Phred scores.
-         * @param reads_fpath File containing reads.
+         * Record the length and base Phred scores of a read, as it is parsed for mapping.
+         * Not thread safe: each reader thread should record into its own `ReadStats`, to be combined with `add_read_stats`.
+         */
+        void record_read(const GenomicRead &read);
+
+        /**
+         * Combine the read quality statistics recorded into `other` with those of this object.
          */
-        void compute_base_error_rate(const std::string &reads_fpath);
+        void add_read_stats(const ReadStats &other);
+
+        /**
+         * Compute probability of erroneous base from the base Phred scores of all recorded reads.
+         */
+        void compute_base_error_rate();
 
         /**
          * Compute the depth of coverage using recorded coverage of reads over variant sites after `quasimap`.
+         * Site depths are accumulated in a single pass, without being stored.
          * @param coverage gram::Coverage containing read coverage over variant sites.
          */
-        void compute_coverage_depth(Coverage &coverage);
+        void compute_coverage_depth(const Coverage &coverage);
+
+        double get_mean_error() const { return mean_error; }
+        int64_t get_no_qual_reads() const { return no_qual_reads; }
+        double get_max_read_length() const { return max_read_length; }
+        int64_t get_num_bases_processed() const { return num_bases_processed; }
+        double get_mean_depth() const { return mean_depth; }
+        double get_variance_depth() const { return variance_depth; }
+        int64_t get_num_sites_noCov() const { return num_sites_noCov; }
 
         void serialise(const std::string &json_output_fpath);
 
@@ -42,6 +61,7 @@ namespace gram {
         int64_t no_qual_reads;
         double max_read_length;
         int64_t num_bases_processed;
+        double total_qual_score = 0;
 
         double mean_depth;
         double variance_depth;
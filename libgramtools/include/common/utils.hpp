@@ -1,6 +1,9 @@
 /** @file
  * Defines a set of data structures and functions common to the backend.
  */
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
 #include <vector>
 #include <list>
 #include <cstdint>
@@ -43,7 +46,48 @@ namespace gram {
     using AlleleId = uint32_t; /**< An integer describing which allele is referred to within a given variant site. */
 
     using VariantLocus = std::pair<Marker, AlleleId>; /**< A Variant site/`AlleleId` combination.*/
-    using VariantSitePath = std::list<VariantLocus>; /**< A path through variant sites is a list of allele/site combinations. */
+    /**
+     * A path through variant sites: the allele/site combinations traversed, in prg order.
+     * Backward search extends a path at its front, so the loci are stored contiguously in reverse order:
+     * extending appends to the vector, and iteration walks it backwards.
+     */
+    class VariantSitePath {
+    public:
+        using value_type = VariantLocus;
+        using const_iterator = std::vector<VariantLocus>::const_reverse_iterator;
+        using iterator = const_iterator;
+
+        VariantSitePath() = default;
+
+        VariantSitePath(std::initializer_list<VariantLocus> loci) : reversed_loci(std::rbegin(loci), std::rend(loci)) {}
+
+        template<typename InputIterator>
+        VariantSitePath(InputIterator first, InputIterator last) : reversed_loci(first, last) {
+            std::reverse(reversed_loci.begin(), reversed_loci.end());
+        }
+
+        void push_front(const VariantLocus &locus) { reversed_loci.push_back(locus); }
+
+        const VariantLocus &front() const { return reversed_loci.back(); }
+
+        const VariantLocus &back() const { return reversed_loci.front(); }
+
+        const_iterator begin() const { return reversed_loci.rbegin(); }
+
+        const_iterator end() const { return reversed_loci.rend(); }
+
+        uint64_t size() const { return reversed_loci.size(); }
+
+        bool empty() const { return reversed_loci.empty(); }
+
+        bool operator==(const VariantSitePath &other) const { return reversed_loci == other.reversed_loci; }
+
+        bool operator!=(const VariantSitePath &other) const { return reversed_loci != other.reversed_loci; }
+
+    private:
+        std::vector<VariantLocus> reversed_loci;
+    };
+
     using VariantSitePaths = std::list<VariantSitePath>;
 
     /** The suffix array (SA) holds the starting index of all (lexicographically sorted) cyclic permutations of the prg.
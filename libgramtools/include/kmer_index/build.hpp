@@ -21,15 +21,6 @@
 
 namespace gram {
 
-    /**
-     * Stores the total number of indexed kmers, the total number of computed `gram::SA_Interval`s, and the total number of traversed `gram::VariantLocus`.
-     */
-    struct KmerIndexStats {
-        uint64_t count_kmers;
-        uint64_t count_search_states;
-        uint64_t count_total_path_elements;
-    };
-
     struct IndexedKmerStats {
         uint64_t count_search_states;
         std::vector<uint64_t> path_lengths;
@@ -41,12 +32,32 @@ namespace gram {
     };
 
 
+    using KmerPartition = std::pair<uint64_t, uint64_t>; /**< A range [first, second) of kmers. */
+
+    /**
+     * Splits the kmers into about `count_partitions` ranges which can be indexed independently.
+     * Each range starts at a full kmer (prefix diff length == `kmer_size`), where the `KmerIndexCache` would be reset anyway.
+     */
+    std::vector<KmerPartition> get_kmer_partitions(const std::vector<uint8_t> &prefix_diff_lengths,
+                                                   const int kmer_size,
+                                                   const uint64_t &count_partitions);
+
     /**
      * For each kmer, find its `SearchStates` and populate the `KmerIndex`.
-     * @see update_full_kmer()
+     * Partitions of the kmers are indexed in parallel, each with its own cache.
+     * @see get_kmer_partitions()
+     * @param reverse_kmers packed reverse kmers, sorted and without duplicates.
+     * @see get_prefix_diff_lengths()
      * @see update_kmer_index_cache()
      */
-    KmerIndex index_kmers(const Patterns &kmers, const int kmer_size, const PRG_Info &prg_info);
+    KmerIndex index_kmers(const PackedKmers &reverse_kmers, const int kmer_size, const PRG_Info &prg_info);
+
+    /**
+     * Indexes kmers given as prefix diffs, each relative to its predecessor.
+     * @see get_prefix_diffs()
+     * @see update_full_kmer()
+     */
+    KmerIndex index_kmers(const Patterns &kmer_prefix_diffs, const int kmer_size, const PRG_Info &prg_info);
 
     namespace kmer_index {
         KmerIndex build(const Parameters &parameters,
@@ -1,7 +1,10 @@
 /** @file
  * Defines the kmer index and the caching structure for remembering the relevant previous mappings.
  */
+#include <initializer_list>
+
 #include "common/utils.hpp"
+#include "common/memory_map.hpp"
 #include "search/search_types.hpp"
 
 
@@ -18,7 +21,132 @@ namespace gram {
     };
     using KmerIndexCache = std::list<CacheElement>; /**< Stored previously computed `SearchStates` for re-use when indexing different kmers. */
 
-    using KmerIndex = SequenceHashMap<Pattern, SearchStates>; /**< Unordered map linking a kmer to all mapped locations in the prg.*/
+    /**
+     * A kmer packed two bits per base (A=00, C=01, G=10, T=11), first base in the most significant position.
+     * Packed kmers therefore sort in the same order as their bases.
+     */
+    using PackedKmer = uint64_t;
+    constexpr uint32_t max_packed_kmer_size = 32;
+    constexpr uint32_t max_direct_lookup_kmer_size = 13; /**< Largest kmer size for which a table over all 4^k kmers is kept. */
+
+    /**
+     * Packs a kmer of at most `max_packed_kmer_size` `Base`s (range: 1-4).
+     */
+    PackedKmer pack_kmer(const Pattern &kmer);
+
+    Pattern unpack_kmer(const PackedKmer &packed_kmer, const uint32_t &kmer_size);
+
+    using PackedKmers = std::vector<PackedKmer>;
+
+    Patterns unpack_kmers(const PackedKmers &packed_kmers, const uint32_t &kmer_size);
+
+    using KmerIndexEntry = std::pair<PackedKmer, SearchStates>;
+    using KmerIndexEntries = std::vector<KmerIndexEntry>;
+
+    /**
+     * Links each indexed kmer to all its mapped locations in the prg.
+     *
+     * The index is stored in compressed sparse row (CSR) form: the packed kmers are sorted and the `SearchStates`
+     * of the kmer at position `i` occupy the range `[search_states_offsets[i], search_states_offsets[i + 1])`
+     * of the per search state arrays. Likewise, the `VariantSitePath` of search state `j` occupies the range
+     * `[paths_offsets[j], paths_offsets[j + 1])` of `paths`. A lookup is a binary search over `kmers`,
+     * and no memory is allocated per kmer or per search state.
+     * For small kmer sizes, `direct_lookup` can replace the binary search with a single table access.
+     * The arrays either own their elements or view a mapped kmer index file (@see load_kmer_index_file()).
+     */
+    struct KmerIndex {
+        uint32_t kmer_size = 0;
+        MappedVector<PackedKmer> kmers; /**< Sorted, distinct. */
+        MappedVector<uint64_t> search_states_offsets = {0}; /**< One entry per kmer, plus a closing offset. */
+
+        MappedVector<SA_Interval> sa_intervals; /**< One entry per search state. */
+        MappedVector<SearchVariantSiteState> variant_site_states; /**< One entry per search state. */
+        MappedVector<uint64_t> paths_offsets = {0}; /**< One entry per search state, plus a closing offset. */
+        MappedVector<VariantLocus> paths;
+
+        /**
+         * Optional, derived from `kmers`: indexed by packed kmer, gives the kmer's position in `kmers`
+         * or `direct_lookup_absent`. Empty unless built with `build_direct_lookup()`.
+         */
+        std::vector<uint32_t> direct_lookup;
+
+        static constexpr uint64_t npos = UINT64_MAX;
+        static constexpr uint32_t direct_lookup_absent = UINT32_MAX;
+
+        KmerIndex() = default;
+
+        /**
+         * Lays out the given entries in CSR form. Entries need not be sorted; for a repeated kmer, the last entry is kept.
+         */
+        KmerIndex(const uint32_t &kmer_size, KmerIndexEntries entries);
+
+        KmerIndex(std::initializer_list<std::pair<Pattern, SearchStates>> entries);
+
+        uint64_t size() const { return kmers.size(); }
+
+        bool empty() const { return kmers.empty(); }
+
+        /**
+         * @return the position of `packed_kmer` in `kmers`, or `npos` if it is not indexed.
+         */
+        uint64_t find(const PackedKmer &packed_kmer) const;
+
+        uint64_t find(const Pattern &kmer) const;
+
+        bool contains(const Pattern &kmer) const { return find(kmer) != npos; }
+
+        /**
+         * Rebuilds the `SearchStates` of the kmer at position `kmer_position`.
+         */
+        SearchStates search_states(const uint64_t &kmer_position) const;
+
+        /**
+         * @return the `SearchStates` of `kmer`, or empty `SearchStates` if it is not indexed.
+         * @note unlike a map, querying a missing kmer does not insert it.
+         */
+        SearchStates operator[](const Pattern &kmer) const;
+
+        /**
+         * Fills `direct_lookup` for all 4^k packed kmers.
+         * @note requires `kmer_size <= max_direct_lookup_kmer_size`.
+         */
+        void build_direct_lookup();
+
+        /**
+         * Compares the indexed kmers and their `SearchStates`; `direct_lookup` is not compared.
+         */
+        bool operator==(const KmerIndex &other) const;
+    };
+
+    /**
+     * Selects the seeding mode of the kmer index: a direct-addressed table is used when the kmer size is small
+     * enough and the table has no more entries than four times the prg length.
+     */
+    bool use_direct_lookup(const uint32_t &kmer_size, const uint64_t &prg_size);
+
+    constexpr uint32_t kmer_index_file_version = 1;
+    constexpr uint64_t kmer_index_file_byte_order = 0x0102030405060708; /**< Read back differently on a host of other endianness. */
+    constexpr uint64_t kmer_index_file_alignment = 8; /**< Each array of the file starts at a multiple of this many bytes. */
+
+    /**
+     * Leads the kmer index file. It is followed by the `gram::KmerIndex` arrays, each padded to `kmer_index_file_alignment`, in order:
+     * `kmers`, `search_states_offsets`, `paths_offsets`, `sa_intervals`, `paths`, `variant_site_states`.
+     */
+    struct KmerIndexFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t kmer_size;
+        uint64_t byte_order;
+        uint64_t count_kmers;
+        uint64_t count_search_states;
+        uint64_t count_path_elements;
+        uint64_t reserved[2];
+    };
+    static_assert(sizeof(KmerIndexFileHeader) == 64, "the kmer index file header layout is fixed");
+    static_assert(sizeof(SA_Interval) == 8 and sizeof(VariantLocus) == 8,
+                  "the kmer index file stores SA intervals and variant loci as pairs of 32 bit integers");
+
+    constexpr char kmer_index_file_magic[8] = {'G', 'R', 'A', 'M', 'K', 'I', 'D', 'X'};
 }
 
 #endif //GRAMTOOLS_KMER_INDEX_TYPES_HPP
@@ -36,6 +36,7 @@
 #include "prg/prg.hpp"
 #include "common/parameters.hpp"
 #include "common/utils.hpp"
+#include "kmer_index/kmer_index_types.hpp"
 
 
 #ifndef GRAMTOOLS_KMERS_HPP
@@ -142,7 +143,10 @@ namespace gram {
     /**
      * Extracts all kmers to index from the `region_parts` that can be traversed.
      * @param region_parts The variant and non-variant regions within reach of a starting position in the prg.
-     * @return all unique kmers extracted from all enumerated path through the `region_parts`.
+     * @return all unique kmers of all paths through the `region_parts`.
+     * @note paths are not enumerated, as their number is a product over sites. The distinct walks of fewer than
+     * `kmer_size` bases ending each region part are carried over to the next one instead, so that the work done is
+     * proportional to the number of distinct kmers.
      */
     unordered_vector_set<Pattern> get_region_parts_reverse_kmers(const std::list<Patterns> &region_parts,
                                                                  const uint64_t &kmer_size);
@@ -183,13 +187,13 @@ namespace gram {
     std::vector<PrgIndexRange> combine_overlapping_regions(const std::vector<PrgIndexRange> &kmer_region_ranges);
 
     /**
-     * Converts an ordered_set of kmers into a vector of kmers in the reverse order.
-     * The use of this is that the ordered_set when applied on kmers stored right-to-left in the prg,
+     * Converts a sorted list of kmers into a vector of kmers in the reverse order.
+     * The use of this is that the sorted list when applied on kmers stored right-to-left in the prg,
      * naturally maximises the shared suffix between consecutive entries. Reversing them so that they are
      * left-to-right in the prg, readies the kmers for the cached indexing process.
      * @see gram::get_prefix_diffs()
      */
-    std::vector<Pattern> reverse(const ordered_vector_set<Pattern> &reverse_kmers);
+    std::vector<Pattern> reverse(const Patterns &reverse_kmers);
 
     /**
      * Computes the minimal changes between kmers and their immediate predecessor in the ordered set.
@@ -197,26 +201,46 @@ namespace gram {
      */
     std::vector<Pattern> get_prefix_diffs(const std::vector<Pattern> &kmers);
 
+    /**
+     * Sorts packed kmers with a parallel least significant digit radix sort, then removes duplicates in place.
+     * Only the `2 * kmer_size` low bits are sorted on.
+     */
+    void sort_packed_kmers(PackedKmers &packed_kmers, const uint32_t &kmer_size);
+
+    /**
+     * Computes the length of the prefix diff of each kmer relative to its predecessor, from the packed reverse kmers:
+     * the leading zeros of two consecutive packed reverse kmers XORed together give the length of their common suffix.
+     * The first kmer gets a prefix diff of `kmer_size`, as does any kmer sharing no suffix with its predecessor.
+     */
+    std::vector<uint8_t> get_prefix_diff_lengths(const PackedKmers &reverse_kmers, const uint32_t &kmer_size);
+
     /**
      * Extract kmers to index from a prg. Only kmers in the prg whose mapping can overlap a variant site will get indexed.
-     * @return all the kmers to index, in reverse sorted order. The kmers are maintained in reverse (first kmer position == last position in prg)
-     * so that they get inserted in sorted (dictionary) order.
+     * Regions of the prg are processed in parallel.
+     * @return all the kmers to index, packed in reverse (first kmer position == last position in prg),
+     * sorted and without duplicates, so that consecutive kmers share maximal suffixes.
      */
-    ordered_vector_set<Pattern> get_prg_reverse_kmers(const Parameters &parameters,
-                                                      const PRG_Info &prg_info);
+    PackedKmers get_prg_reverse_kmers(const Parameters &parameters,
+                                      const PRG_Info &prg_info);
 
     /**
-     * High-level routine for extracting all kmers of interest and computing the prefix differences.
+     * Produces the packed reverse kmers to index, sorted and without duplicates.
+     * If `all_kmers_flag` is unset (the default), only the relevant kmers are produced; these are the kmers overlapping
+     * variant sites in the prg. If it is set, produces all the kmers of given size.
      * @see gram::kmer_index::build()
      */
+    PackedKmers get_all_reverse_kmers(const Parameters &parameters,
+                                      const PRG_Info &prg_info);
+
+    /**
+     * Extracts all kmers of interest and computes their prefix differences, as `Pattern`s.
+     * @see get_all_reverse_kmers() for the packed kmers used by gram::kmer_index::build()
+     */
     std::vector<Pattern> get_all_kmer_and_compute_prefix_diffs(const Parameters &parameters,
                                                                const PRG_Info &prg_info);
 
     /**
-     * Core routine for producing kmers to index.
-     * If `all_kmers_flag` is unset (the default), only the relevant kmers are produced; these are the kmers overlapping
-     * variant sites in the prg.
-     * If it is set, produces all the kmers of given size.
+     * Unpacks and reverses the kmers produced by `get_all_reverse_kmers()`, in order.
      */
     std::vector<Pattern> get_all_kmers(const Parameters &parameters,
                                        const PRG_Info &prg_info);
@@ -224,10 +248,9 @@ namespace gram {
     /**
      * Generate all kmers of a given size, in order.
      * Order is a dictionary order ('1111'<'1121' < '1211' etc..)
-     * Kmers themselves are produced in order ('1111' then '1112' etc..)
-     * @see next_kmer()
+     * Kmers themselves are produced in order ('1111' then '1112' etc..), by unpacking each `gram::PackedKmer` in turn.
      */
-    ordered_vector_set<Pattern> generate_all_kmers(const uint64_t &kmer_size);
+    std::vector<Pattern> generate_all_kmers(const uint64_t &kmer_size);
 
 }
 
@@ -30,20 +30,32 @@ namespace gram {
 
     /**
      * Rebuilds `gram::SearchStates` for each indexed kmer, populating each `gram::SearchState` with an `gram::SA_Interval`.
+     * Lays out the kmer index first if it is empty.
      */
     void parse_sa_intervals(KmerIndex &kmer_index,
                             const sdsl::int_vector<3> &all_kmers,
                             const sdsl::int_vector<> &kmers_stats,
                             const Parameters &parameters);
 
+    /**
+     * Populates each `gram::SearchState` of each indexed kmer with its `gram::VariantSitePath`.
+     * Lays out the kmer index first if it is empty.
+     */
     void parse_paths(KmerIndex &kmer_index,
                      const sdsl::int_vector<3> &all_kmers,
                      const sdsl::int_vector<> &kmers_stats,
                      const Parameters &parameters);
 
+    /**
+     * Memory maps the kmer index file: the `gram::KmerIndex` arrays view the mapped file, so loading does not depend on
+     * the index size and concurrent processes share the index pages. Exits if the file is not a supported kmer index file.
+     */
+    KmerIndex load_kmer_index_file(const Parameters &parameters);
+
     namespace kmer_index {
         /**
          * Rebuild a `gram::KmerIndex` from serialised file in a gramtools `build` produced directory.
+         * Maps the kmer index file if there is one, otherwise parses the separate files of older `build`s.
          */
         KmerIndex load(const Parameters &parameters);
     }
@@ -1,8 +1,12 @@
 /**
  * @file
- * Functions for producing, storing and loading bit masks over the BWT of the prg.
- * A bit mask is a bit vector with a bit set if a given nucleotide base is present in the BWT, and unset otherwise.
+ * Functions for producing, storing and loading the occurrence table of DNA bases over the BWT of the prg.
+ * The table answers rank queries for A, C, G and T, which drive backward search.
  */
+#include <vector>
+
+#include "common/utils.hpp"
+#include "common/memory_map.hpp"
 #include "fm_index.hpp"
 
 
@@ -11,22 +15,100 @@
 
 namespace gram {
 
-    struct DNA_BWT_Masks {
-        sdsl::bit_vector mask_a;
-        sdsl::bit_vector mask_c;
-        sdsl::bit_vector mask_g;
-        sdsl::bit_vector mask_t;
+    /**
+     * One cache line of the occurrence table, covering `DNA_BWT_Occ::block_size` consecutive BWT positions.
+     * Holds the number of each base before the block, and a bit mask per base flagging its presence inside the block.
+     */
+    struct alignas(64) DNA_BWT_OccBlock {
+        uint64_t counts[4];
+        uint64_t bits[4];
     };
 
+    constexpr uint32_t dna_bwt_occ_file_version = 1;
+    constexpr char dna_bwt_occ_file_magic[8] = {'G', 'R', 'A', 'M', 'D', 'O', 'C', 'C'};
+
     /**
-     * Generate BWT bit vector masks for each of A,C,G and T in the BWT of the prg.
+     * Occurrence table of the DNA bases in the BWT, with counts and bit masks for all four bases interleaved.
+     * A rank query for any base reads a single cache line.
      */
-    void generate_dna_bwt_masks(const FM_Index &fm_index,
-                                const Parameters &parameters);
+    class DNA_BWT_Occ {
+    public:
+        static constexpr uint64_t block_size = 64;
+
+        DNA_BWT_Occ() = default;
+
+        explicit DNA_BWT_Occ(const FM_Index &fm_index);
+
+        /**
+         * Views `number_of_blocks` blocks lying in `memory_map`, without copying them.
+         */
+        static DNA_BWT_Occ view(const uint64_t &bwt_size,
+                                const DNA_BWT_OccBlock *blocks,
+                                const uint64_t &number_of_blocks,
+                                MemoryMapPtr memory_map);
+
+        /**
+         * @param upper_index the index into the suffix array/BWT.
+         * @param dna_base the base (1-4) to count in the BWT.
+         * @return the number of occurrences of `dna_base` up to (and excluding) `upper_index` in the BWT.
+         */
+        uint64_t rank(const uint64_t &upper_index, const Base &dna_base) const {
+            const auto &block = blocks[upper_index / block_size];
+            const auto base_index = dna_base - 1;
+            return block.counts[base_index]
+                   + __builtin_popcountll(block.bits[base_index] & prefix_mask(upper_index));
+        }
+
+        /**
+         * The DNA base (1-4) at `index` in the BWT, or 0 if it holds a variant marker or the end of the prg.
+         */
+        Base dna_base(const uint64_t &index) const {
+            const auto &block = blocks[index / block_size];
+            const auto bit = uint64_t(1) << (index % block_size);
+            for (uint64_t i = 0; i < 4; ++i) {
+                if ((block.bits[i] & bit) != 0)
+                    return (Base) (i + 1);
+            }
+            return 0;
+        }
+
+        /** Number of BWT positions covered. */
+        uint64_t size() const { return bwt_size; }
+
+        const DNA_BWT_OccBlock *data() const { return blocks.data(); }
+
+        uint64_t number_of_blocks() const { return blocks.size(); }
 
-    DNA_BWT_Masks load_dna_bwt_masks(const FM_Index &fm_index,
+        void serialize(std::ostream &out) const;
+
+        /**
+         * Reads a table written by `serialize`. Sets the failbit of `in` if the block count does not match the BWT size.
+         */
+        void load(std::istream &in);
+
+        bool operator==(const DNA_BWT_Occ &other) const;
+
+    private:
+        static uint64_t prefix_mask(const uint64_t &upper_index) {
+            return (uint64_t(1) << (upper_index % block_size)) - 1;
+        }
+
+        uint64_t bwt_size = 0;
+        MappedVector<DNA_BWT_OccBlock> blocks;
+    };
+
+    /**
+     * Generate the DNA occurrence table over the BWT of the prg, and store it to disk.
+     */
+    DNA_BWT_Occ generate_dna_bwt_occ(const FM_Index &fm_index,
                                      const Parameters &parameters);
 
+    /**
+     * Loads the DNA occurrence table stored by `generate_dna_bwt_occ`.
+     * Exits if the file cannot be read, is not a DNA occurrence table, or was written by another version.
+     */
+    DNA_BWT_Occ load_dna_bwt_occ(const Parameters &parameters);
+
 }
 
 #endif //GRAMTOOLS_DNA_RANKS_HPP
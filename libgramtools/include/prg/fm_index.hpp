@@ -1,7 +1,9 @@
 /**
  * @file
  * Generates an FM-index of an encoded prg using the SDSL library.
+ * The FM-index is only held during `build`: `quasimap` uses the suffix array and DNA tables derived from it here.
  */
+#include <array>
 #include <sdsl/suffix_arrays.hpp>
 #include <sdsl/wavelet_trees.hpp>
 
@@ -27,6 +29,29 @@ namespace gram {
      */
     FM_Index generate_fm_index(const Parameters &parameters);
 
+    /**
+     * The suffix array values kept when the suffix array is sampled every `sampling_interval` prg positions.
+     * @see gram::locate()
+     */
+    struct SuffixArraySamples {
+        sdsl::int_vector<> suffix_array; /**< Values which are multiples of the interval, in SA order, bit compressed. All values with an interval of 1. */
+        sdsl::bit_vector sa_samples_mask; /**< Flags the SA indexes whose value is in `suffix_array`. Empty when all values are sampled. */
+        sdsl::int_vector<> bwt_markers_sa; /**< Values at the SA indexes where the BWT holds a variant marker, in SA order. Empty when all values are sampled. */
+        sdsl::int_vector<> markers_sa; /**< Values of the suffixes starting with a variant marker, which are the last ones in SA order. Empty when all values are sampled. */
+    };
+
+    /**
+     * Computes all suffix array samples in a single pass over the FM index, reading each SA value and BWT character once.
+     */
+    SuffixArraySamples generate_suffix_array_samples(const FM_Index &fm_index, const uint64_t &sampling_interval = 1);
+
+    using DNA_FirstSA_Indexes = std::array<uint64_t, 5>; /**< Indexed by DNA base (1-4); index 0 is unused. */
+
+    /**
+     * The SA index of the first suffix starting with each DNA base, as needed for backward search.
+     */
+    DNA_FirstSA_Indexes generate_dna_first_sa_indexes(const FM_Index &fm_index);
+
 }
 
 #endif //GRAMTOOLS_PROCESS_PRG_HPP
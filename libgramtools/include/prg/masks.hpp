@@ -47,6 +47,16 @@ namespace gram {
      */
     sdsl::bit_vector generate_bwt_markers_mask(const FM_Index &fm_index);
 
+    /**
+     * The variant markers of the BWT of the prg, in BWT order, bit compressed.
+     * The marker at BWT index `i` is stored at index `rank(bwt_markers_mask, i)`, so that it can be read without
+     * accessing the wavelet tree.
+     * Only the `count_markers` positions flagged in `bwt_markers_mask` are read from the BWT.
+     */
+    sdsl::int_vector<> generate_bwt_markers(const FM_Index &fm_index,
+                                            const sdsl::bit_vector &bwt_markers_mask,
+                                            const uint64_t &count_markers);
+
 }
 
 #endif //GRAMTOOLS_MASKS_H
@@ -19,29 +19,57 @@
 
 namespace gram {
 
+    /**
+     * Positions of a variant site's markers in the prg and in its suffix array.
+     * The start boundary marker is the site marker found first in the prg, the end boundary marker the other one.
+     */
+    struct SiteMarkerInfo {
+        SA_Index start_sa_index; /**< SA index of the suffix starting at the start boundary marker. */
+        SA_Index end_sa_index; /**< SA index of the suffix starting at the end boundary marker. */
+        SA_Index sa_right_of_start; /**< SA index of the suffix starting right after the start boundary marker. */
+        uint64_t start_prg_index;
+        uint64_t end_prg_index;
+        SA_Index allele_marker_first_sa_index; /**< First and last SA index of the suffixes starting at the site's allele markers. */
+        SA_Index allele_marker_last_sa_index;
+        uint64_t count_alleles;
+
+        SA_Interval allele_marker_sa_interval() const {
+            return SA_Interval{allele_marker_first_sa_index, allele_marker_last_sa_index};
+        }
+    };
+    using SitesMarkerInfo = std::vector<SiteMarkerInfo>;
+
     /**
      * The key data structure holding all of the information used for vBWT backward search.
      */
     struct PRG_Info {
-        FM_Index fm_index; /**< FM_index as a `sdsl::csa_wt` from the `sdsl` library. @note Accessing this data structure ([]) accesses the suffix array. */
+        FM_Index fm_index; /**< FM_index as a `sdsl::csa_wt` from the `sdsl` library. @note Only populated by `build`; quasimap uses `suffix_array` and the tables below, which do not need its wavelet tree. */
+        DNA_FirstSA_Indexes dna_first_sa_indexes;
+
+        uint64_t sa_sampling_interval = 1; /**< Suffix array values are kept for one in this many prg positions. */
+        sdsl::int_vector<> suffix_array; /**< The sampled suffix array values, bit compressed: all of them if `sa_sampling_interval` is 1. @see locate() */
+        sdsl::bit_vector sa_samples_mask; /**< Flags the SA indexes with a sampled value. Empty if all are sampled. */
+        sdsl::rank_support_v<1> sa_samples_rank;
+        sdsl::int_vector<> bwt_markers_sa; /**< Suffix array values where the BWT holds a marker, indexed like `bwt_markers`. Empty if all are sampled. */
+        sdsl::int_vector<> markers_sa; /**< Suffix array values of the suffixes starting with a marker (site boundaries and allele ends), which sort last. Empty if all are sampled. */
         sdsl::int_vector<> encoded_prg;
 
         sdsl::int_vector<> sites_mask; /**< Stores the site number at each allele position. Variant markers and outside variant sites get 0.*/
         sdsl::int_vector<> allele_mask; /**< Stores the allele index at each allele position. Variant markers and outside variant sites get 0. */
 
         sdsl::bit_vector bwt_markers_mask; /**< Bit vector flagging variant site marker presence in bwt.*/
+        sdsl::rank_support_v<1> bwt_markers_rank;
+        sdsl::select_support_mcl<1> bwt_markers_select;
+        sdsl::int_vector<> bwt_markers; /**< The marker characters of the bwt, indexed by their rank in `bwt_markers_mask`. @see generate_bwt_markers() */
         uint64_t markers_mask_count_set_bits;
 
         sdsl::bit_vector prg_markers_mask; /**< Bit vector flagging variant site marker presence in prg.*/
         sdsl::rank_support_v<1> prg_markers_rank;
         sdsl::select_support_mcl<1> prg_markers_select;
 
-        DNA_BWT_Masks dna_bwt_masks; /**<Holds bit masks over the bwt for dna nucleotides. Used for rank queries to BWT during backward search. */
-        // Rank support will be provided for each bit mask held in structure above.
-        sdsl::rank_support_v<1> rank_bwt_a;
-        sdsl::rank_support_v<1> rank_bwt_c;
-        sdsl::rank_support_v<1> rank_bwt_g;
-        sdsl::rank_support_v<1> rank_bwt_t;
+        DNA_BWT_Occ dna_bwt_occ; /**< Occurrence table of dna nucleotides over the bwt. Used for rank queries to BWT during backward search. */
+
+        SitesMarkerInfo sites_marker_info; /**< Marker positions of each variant site, indexed by `(site marker - 5) / 2`. */
 
         uint64_t max_alphabet_num;
     };
@@ -56,6 +84,27 @@ namespace gram {
                           const Marker &dna_base,
                           const PRG_Info &prg_info);
 
+    /**
+     * Computes the marker positions of each variant site from the FM index, so that they need not be looked up
+     * in the suffix array each time a read crosses a marker. Site markers absent from the prg get an empty entry.
+     */
+    SitesMarkerInfo generate_sites_marker_info(const FM_Index &fm_index);
+
+    /**
+     * The marker positions of the variant site of a site or allele marker.
+     */
+    inline const SiteMarkerInfo &site_marker_info(const Marker &marker, const PRG_Info &prg_info) {
+        return prg_info.sites_marker_info[(marker - 5) / 2];
+    }
+
+    /**
+     * The prg position of the suffix at `sa_index`.
+     * If the suffix array is sampled, walks the LF mapping (using the DNA occurrence table) towards the start of the prg
+     * until a suffix with a known position is reached. Positions of suffixes starting at or right after a marker are
+     * always known, so the walk takes fewer than `sa_sampling_interval` steps and never needs the BWT marker characters.
+     */
+    uint64_t locate(const uint64_t &sa_index, const PRG_Info &prg_info);
+
     /**
      * Finds largest integer in the (integer-encoded) prg.
      */
@@ -107,9 +156,11 @@ namespace gram {
 
     /**
      * Populates PRG_Info struct from disk.
-     * Contains encoded prg, fm_index and masks over the prg and the BWT of the prg with rank and select support.
-     * Note that the fm_index contains the bwt, and that **it** has rank support.
+     * Contains encoded prg, suffix array and masks over the prg and the BWT of the prg with rank and select support.
+     * Ranks of DNA bases in the BWT come from `gram::DNA_BWT_Occ`; the fm_index and its wavelet tree are not kept.
+     * Maps the prg info bundle written by `build` if there is one; otherwise loads and recomputes each component.
      * @see PRG_Info()
+     * @see load_prg_info_bundle()
      */
     PRG_Info load_prg_info(const Parameters &parameters);
 
@@ -0,0 +1,31 @@
+/** @file
+ * Stores all of `gram::PRG_Info` in a single file written by `build`, and maps it back for `quasimap`.
+ * Each component lies in its own page-aligned section. Rank and select supports are stored rather than recomputed,
+ * and the DNA occurrence table is used in place from the mapped file.
+ * The FM index is not stored: its suffix array and the tables derived from its BWT are all that `quasimap` uses.
+ */
+#include "common/parameters.hpp"
+#include "prg/prg.hpp"
+
+
+#ifndef GRAMTOOLS_PRG_BUNDLE_HPP
+#define GRAMTOOLS_PRG_BUNDLE_HPP
+
+namespace gram {
+
+    constexpr uint32_t prg_info_bundle_version = 5;
+
+    /**
+     * Writes a `gram::PRG_Info` populated by `build` to the prg info bundle file.
+     */
+    void dump_prg_info_bundle(const PRG_Info &prg_info, const Parameters &parameters);
+
+    /**
+     * Maps the prg info bundle file and populates a `gram::PRG_Info` from it.
+     * Exits if the file is not a supported prg info bundle.
+     */
+    PRG_Info load_prg_info_bundle(const Parameters &parameters);
+
+}
+
+#endif //GRAMTOOLS_PRG_BUNDLE_HPP
@@ -1,6 +1,7 @@
 /**@file
  * Defines coverage related operations for base-level allele coverage.
  */
+#include "common/buffered_writer.hpp"
 #include "search/search_types.hpp"
 #include "quasimap/coverage/types.hpp"
 
@@ -14,9 +15,11 @@ namespace gram {
         namespace generate {
             /**
              * Produce base-level coverage recording structure.
+             * @param width the width of the base counters, which saturate at their maximum.
              * @see types.hpp
              */
-            SitesAlleleBaseCoverage allele_base_structure(const PRG_Info &prg_info);
+            SitesAlleleBaseCoverage allele_base_structure(const PRG_Info &prg_info,
+                                                          const BaseCoverageWidth &width = BaseCoverageWidth::bits32);
         }
 
         namespace record {
@@ -31,15 +34,29 @@ namespace gram {
                              const PRG_Info &prg_info);
         }
 
+        namespace merge {
+            /**
+             * Adds the base coverage of each of `coverage_shards` into `coverage`, saturating at the maximum base count.
+             * Counters are merged in parallel.
+             */
+            void allele_base(Coverage &coverage,
+                             const std::vector<Coverage> &coverage_shards);
+        }
+
         namespace dump {
             /**
-             * String serialise the coverage information in JSON format and write it to disk.
+             * Serialise the coverage information in JSON format, streaming it to disk.
              */
             void allele_base(const Coverage &coverage,
                              const Parameters &parameters);
         }
     }
 
+    /**
+     * Writes the base-level coverage of all sites in JSON format.
+     */
+    void dump_allele_base_coverage(BufferedWriter &writer, const SitesAlleleBaseCoverage &sites);
+
     std::string dump_allele_base_coverage(const SitesAlleleBaseCoverage &sites);
 
     /**
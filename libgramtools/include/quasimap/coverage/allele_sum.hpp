@@ -29,6 +29,14 @@ namespace gram::coverage {
                         const SearchStates &search_states);
     }
 
+    namespace merge {
+        /**
+         * Adds the allele sum counts of each of `coverage_shards` into `coverage`. Sites are merged in parallel.
+         */
+        void allele_sum(Coverage &coverage,
+                        const std::vector<Coverage> &coverage_shards);
+    }
+
     namespace dump {
         void allele_sum(const Coverage &coverage,
                         const Parameters &parameters);
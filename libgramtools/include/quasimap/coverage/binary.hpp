@@ -0,0 +1,105 @@
+/** @file
+ * Compact binary serialisation of all coverage metrics, as an alternative to the JSON outputs.
+ *
+ * Layout (integers in the header and index are little-endian `uint64_t`):
+ * * header: magic, format version, number of sites, number of allele groups, offset of the allele groups, offset of the index.
+ * * one record per site, holding its allele sum coverage, allele base coverage and grouped allele counts.
+ * * the allele groups table: the allele IDs of each group ID.
+ * * the index: the offset of each site record, followed by the end of the last record.
+ *
+ * Record fields are LEB128 varints. Sequences which vary slowly (per base coverage along an allele, allele IDs in a group)
+ * are delta coded, and deltas which can be negative are zigzag coded.
+ */
+#include <string>
+#include <vector>
+
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+#include "common/parameters.hpp"
+#include "common/memory_map.hpp"
+#include "quasimap/coverage/types.hpp"
+
+
+#ifndef GRAMTOOLS_COVERAGE_BINARY_HPP
+#define GRAMTOOLS_COVERAGE_BINARY_HPP
+
+namespace gram {
+
+    constexpr char binary_coverage_magic[8] = {'G', 'R', 'A', 'M', 'C', 'O', 'V', '\0'};
+    constexpr uint64_t binary_coverage_version = 1;
+
+    namespace coverage::dump {
+        /**
+         * Writes all coverage metrics to `parameters.binary_coverage_fpath`.
+         */
+        void binary(const Coverage &coverage,
+                    const Parameters &parameters);
+    }
+
+    /**
+     * Writes all coverage metrics to `fpath` in the binary coverage format.
+     * Site records are written as they are encoded, so that the whole output is never held in memory.
+     */
+    void write_binary_coverage(const Coverage &coverage, const std::string &fpath);
+
+    /**
+     * The coverage metrics of a single variant site.
+     */
+    struct SiteCoverage {
+        std::vector<uint64_t> allele_sum_coverage;
+        AlleleCoverage allele_base_coverage;
+        GroupedAlleleCounts grouped_allele_counts;
+    };
+
+    /**
+     * Reads a binary coverage file. The file is memory mapped, and any site can be decoded on its own through the index.
+     * Exits if the file is not a valid binary coverage file.
+     */
+    class BinaryCoverageReader {
+    public:
+        explicit BinaryCoverageReader(const std::string &fpath);
+
+        uint64_t count_sites() const { return number_of_sites; }
+
+        /**
+         * The allele IDs of each allele group, indexed by group ID.
+         */
+        const std::vector<AlleleIds> &allele_groups() const { return allele_ids_groups; }
+
+        SiteCoverage site(const uint64_t &site_index) const;
+
+        /**
+         * Decodes all sites, in parallel.
+         */
+        Coverage read_all() const;
+
+    private:
+        std::string fpath;
+        MemoryMapPtr memory_map;
+        uint64_t number_of_sites = 0;
+        uint64_t groups_offset = 0; /**< Site records lie between the header and this offset. */
+        const char *index = nullptr;
+        std::vector<AlleleIds> allele_ids_groups;
+        std::vector<AlleleGroupKey> allele_group_keys;
+
+        uint64_t site_offset(const uint64_t &site_index) const;
+    };
+
+    namespace commands::coverage_to_json {
+        /**
+         * Parses the parameters of the `coverage_to_json` command: a binary coverage file, and the directory to write
+         * its JSON (and allele sum) coverage files to.
+         */
+        Parameters parse_parameters(boost::program_options::variables_map &vm,
+                                    const boost::program_options::parsed_options &parsed);
+
+        /**
+         * Converts a binary coverage file to the files which `quasimap` writes with `--coverage-format json`.
+         */
+        void run(const Parameters &parameters);
+    }
+
+}
+
+#endif //GRAMTOOLS_COVERAGE_BINARY_HPP
@@ -7,6 +7,21 @@
 
 namespace gram {
 
+    /**
+     * Pseudo-random number stream (splitmix64) for selecting among the mappings of multi-mapping reads.
+     * It is cheap to seed, so that each read gets its own stream, derived from the run's seed and the read's id:
+     * selections then depend neither on the number of threads nor on which thread maps which read.
+     */
+    class RandomGenerator {
+    public:
+        RandomGenerator(const uint64_t &seed, const uint64_t &stream_id);
+
+        uint64_t next();
+
+    private:
+        uint64_t state;
+    };
+
     /**
      * Each type of coverage operation (record, generate, dump) operates on each level of coverage information.
      */
@@ -20,19 +35,29 @@ namespace gram {
                                const SearchStates &search_states,
                                const uint64_t &read_length,
                                const PRG_Info &prg_info,
-                               const uint32_t &random_seed = 0);
+                               RandomGenerator &random_generator);
         }
 
         namespace generate {
             /**
              * Calls the routines for building empty structures to record different types of coverage information.
+             * @param base_coverage_width the width of the base-level coverage counters.
+             */
+            Coverage empty_structure(const PRG_Info &prg_info,
+                                     const BaseCoverageWidth &base_coverage_width = BaseCoverageWidth::bits32);
+        }
+
+        namespace merge {
+            /**
+             * Reduces per-thread coverage shards into a single `Coverage`.
+             * The first shard is reused as the result; the others are added into it, site by site.
              */
-            Coverage empty_structure(const PRG_Info &prg_info);
+            Coverage all(std::vector<Coverage> coverage_shards);
         }
 
         namespace dump {
             /**
-             * Write coverage information to disk.
+             * Write coverage information to disk, in `parameters.coverage_format`.
              */
             void all(const Coverage &coverage,
                      const Parameters &parameters);
@@ -49,7 +74,12 @@ namespace gram {
 
     uint64_t random_int_inclusive(const uint64_t &min,
                                   const uint64_t &max,
-                                  const uint64_t &random_seed);
+                                  RandomGenerator &random_generator);
+
+    /**
+     * Resolves the `--seed` parameter: 0 draws a seed from the system's entropy source, once per run.
+     */
+    uint32_t resolve_random_seed(const uint32_t &seed);
 
     uint32_t count_nonvariant_search_states(const SearchStates &search_states);
 
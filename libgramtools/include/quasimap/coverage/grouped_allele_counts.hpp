@@ -1,6 +1,7 @@
 /** @file
 * Defines coverage related operations for base-level allele coverage.
 */
+#include "common/buffered_writer.hpp"
 #include "search/search_types.hpp"
 #include "quasimap/coverage/types.hpp"
 
@@ -29,9 +30,17 @@ namespace gram {
                                        const SearchStates &search_states);
         }
 
+        namespace merge {
+            /**
+             * Adds the allele group counts of each of `coverage_shards` into `coverage`. Sites are merged in parallel.
+             */
+            void grouped_allele_counts(Coverage &coverage,
+                                       const std::vector<Coverage> &coverage_shards);
+        }
+
         namespace dump {
             /**
-             * Write grouped allele coverage to disk in JSON format.
+             * Write grouped allele coverage to disk in JSON format, streaming it.
              */
             void grouped_allele_counts(const Coverage &coverage,
                                        const Parameters &parameters);
@@ -40,27 +49,48 @@ namespace gram {
 
     /**
      * Assigns a unique group ID to each distinct `gram::AlleleIds` group.
+     * IDs are given in order of first occurrence, visiting sites in order and the groups of a site in
+     * lexicographic order, so that they only depend on the counts and not on the order reads were recorded in.
      */
     AlleleGroupHash hash_allele_groups(const SitesGroupedAlleleCounts &sites);
 
     /**
-     * String-serialise a single site count.
+     * JSON serialise a single site count.
      * Outputs an allele group ID and a count of reads mapped to that allele ID combination.
      * If no read has mapped to the site, outputs an empty entry ("{}").
+     * Entries are ordered by group ID.
      */
+    void dump_site(BufferedWriter &writer,
+                   const AlleleGroupHash &allele_ids_groups_hash,
+                   const GroupedAlleleCounts &site);
+
     std::string dump_site(const AlleleGroupHash &allele_ids_groups_hash,
                           const GroupedAlleleCounts &site);
 
     /**
-     * String-serialise site counts in JSON format.
+     * JSON serialise site counts.
      * Site counts is an array where each element refers to a site.
      * @see dump_site()
      */
+    void dump_site_counts(BufferedWriter &writer,
+                          const AlleleGroupHash &allele_ids_groups_hash,
+                          const SitesGroupedAlleleCounts &sites);
+
     std::string dump_site_counts(const AlleleGroupHash &allele_ids_groups_hash,
                                  const SitesGroupedAlleleCounts &sites);
 
+    /**
+     * JSON serialise the allele IDs of each group, ordered by group ID.
+     */
+    void dump_allele_groups(BufferedWriter &writer, const AlleleGroupHash &allele_ids_groups_hash);
+
     std::string dump_allele_groups(const AlleleGroupHash &allele_ids_groups_hash);
 
+    /**
+     * JSON serialise site counts and allele groups.
+     */
+    void dump_grouped_allele_counts(BufferedWriter &writer, const SitesGroupedAlleleCounts &sites);
+
     std::string dump_grouped_allele_counts(const SitesGroupedAlleleCounts &sites);
 }
 
@@ -1,7 +1,11 @@
 /** @file
  * Defines coverage related types.
  */
+#include <limits>
+#include <ostream>
+
 #include "common/utils.hpp"
+#include "common/parameters.hpp"
 
 
 #ifndef GRAMTOOLS_COVERAGE_TYPES_HPP
@@ -16,17 +20,182 @@ namespace gram {
 
     /** Vector of `gram::AlleleId`. Used to store different alleles of the same variant site both by a read.*/
     using AlleleIds = std::vector<AlleleId>;
-    /* An unordered_map associating a group of alleles (`gram::AlleleIds`) with a count of how many reads mapped to this group.*/
-    using GroupedAlleleCounts = SequenceHashMap<AlleleIds, uint64_t>;
-    /** A vector containing unordered_maps of allele group counts.
+
+    /**
+     * An integer standing for a group of alleles (`gram::AlleleIds`).
+     * A group whose allele IDs are all below `max_bitset_allele_id` is the bitset of its allele IDs.
+     * Any other group is interned in a process wide table, and is its table index with the top bit set.
+     * Either way, a group always has the same key, so keys can be compared and merged without the table.
+     */
+    using AlleleGroupKey = uint64_t;
+
+    constexpr AlleleId max_bitset_allele_id = 63;
+
+    /**
+     * @param allele_ids sorted, distinct allele IDs.
+     */
+    AlleleGroupKey allele_group_key(const AlleleIds &allele_ids);
+
+    /**
+     * The sorted allele IDs of the group with `key`.
+     */
+    AlleleIds allele_group_ids(const AlleleGroupKey &key);
+
+    /**
+     * Orders groups by their allele IDs, lexicographically.
+     */
+    bool allele_group_less(const AlleleGroupKey &lhs, const AlleleGroupKey &rhs);
+
+    /**
+     * Associates groups of alleles with a count of how many reads mapped to this group, within one variant site.
+     * Entries are keyed by `gram::AlleleGroupKey`, so that recording a read is an integer-keyed increment.
+     */
+    class GroupedAlleleCounts {
+    public:
+        using Counts = std::unordered_map<AlleleGroupKey, uint64_t>;
+
+        GroupedAlleleCounts() = default;
+
+        GroupedAlleleCounts(std::initializer_list<std::pair<AlleleIds, uint64_t>> entries) {
+            for (const auto &entry: entries)
+                counts[allele_group_key(entry.first)] = entry.second;
+        }
+
+        uint64_t &operator[](const AlleleGroupKey &key) { return counts[key]; }
+
+        uint64_t &operator[](const AlleleIds &allele_ids) { return counts[allele_group_key(allele_ids)]; }
+
+        Counts::const_iterator begin() const { return counts.begin(); }
+
+        Counts::const_iterator end() const { return counts.end(); }
+
+        uint64_t size() const { return counts.size(); }
+
+        bool empty() const { return counts.empty(); }
+
+        bool operator==(const GroupedAlleleCounts &other) const { return counts == other.counts; }
+
+        bool operator!=(const GroupedAlleleCounts &other) const { return counts != other.counts; }
+
+    private:
+        Counts counts;
+    };
+
+    /**
+     * Prints the allele IDs and count of each group, for test failure messages.
+     */
+    std::ostream &operator<<(std::ostream &stream, const GroupedAlleleCounts &site);
+
+    /** A vector containing allele group counts.
      * There is one such map per variant site in the prg.*/
     using SitesGroupedAlleleCounts = std::vector<GroupedAlleleCounts>;
 
-    using AlleleGroupHash = SequenceHashMap<AlleleIds, uint64_t>;
+    /** Associates each allele group with the ID it is given in the coverage output. */
+    using AlleleGroupHash = std::unordered_map<AlleleGroupKey, uint64_t>;
 
-    using BaseCoverage = std::vector<uint16_t>; /**< Number of reads mapped to each base of an allele */
+    using BaseCoverage = std::vector<uint32_t>; /**< Number of reads mapped to each base of an allele */
     using AlleleCoverage = std::vector<BaseCoverage>; /**< `gram::BaseCoverage` for each allele of a variant site. */
-    using SitesAlleleBaseCoverage = std::vector<AlleleCoverage>; /**< Vector of gram::AlleleCoverage, one for each variant site in the prg. */
+
+    /**
+     * Base-level coverage of each allele of each variant site in the prg.
+     * All counters are held in one contiguous array: alleles are laid out one after the other, in site order.
+     * `site_offsets` gives each site's first allele, and `allele_offsets` each allele's first counter.
+     */
+    class SitesAlleleBaseCoverage {
+    public:
+        SitesAlleleBaseCoverage() = default;
+
+        /**
+         * Zero coverage, for alleles of the given sizes.
+         * @param sites_allele_sizes the size of each allele of each site.
+         */
+        SitesAlleleBaseCoverage(const std::vector<std::vector<uint64_t>> &sites_allele_sizes,
+                                const BaseCoverageWidth &width);
+
+        /**
+         * Copies nested per site coverage.
+         */
+        explicit SitesAlleleBaseCoverage(const std::vector<AlleleCoverage> &sites,
+                                         const BaseCoverageWidth &width = BaseCoverageWidth::bits32);
+
+        SitesAlleleBaseCoverage(std::initializer_list<AlleleCoverage> sites)
+                : SitesAlleleBaseCoverage(std::vector<AlleleCoverage>(sites)) {}
+
+        BaseCoverageWidth width() const { return counter_width; }
+
+        /** Number of variant sites. */
+        uint64_t size() const { return site_offsets.empty() ? 0 : site_offsets.size() - 1; }
+
+        bool empty() const { return size() == 0; }
+
+        uint64_t count_alleles(const uint64_t &site_index) const {
+            return site_offsets[site_index + 1] - site_offsets[site_index];
+        }
+
+        uint64_t allele_size(const uint64_t &site_index, const uint64_t &allele_index) const {
+            auto allele = site_offsets[site_index] + allele_index;
+            return allele_offsets[allele + 1] - allele_offsets[allele];
+        }
+
+        uint64_t get(const uint64_t &site_index, const uint64_t &allele_index, const uint64_t &base_index) const {
+            auto counter = allele_offsets[site_offsets[site_index] + allele_index] + base_index;
+            if (counter_width == BaseCoverageWidth::bits16)
+                return counters16[counter];
+            return counters32[counter];
+        }
+
+        /**
+         * Adds one to the coverage of bases [`first_base_index`, `last_base_index`) of an allele.
+         */
+        void increment(const uint64_t &site_index,
+                       const uint64_t &allele_index,
+                       const uint64_t &first_base_index,
+                       const uint64_t &last_base_index) {
+            auto allele_start = allele_offsets[site_offsets[site_index] + allele_index];
+            if (counter_width == BaseCoverageWidth::bits16)
+                increment_counters(counters16, allele_start + first_base_index, allele_start + last_base_index);
+            else
+                increment_counters(counters32, allele_start + first_base_index, allele_start + last_base_index);
+        }
+
+        /**
+         * Adds the counts of `other`, which must have the same layout, saturating at this structure's counter width.
+         */
+        void add(const SitesAlleleBaseCoverage &other);
+
+        /**
+         * Copies the coverage of one site into a nested structure.
+         */
+        AlleleCoverage site(const uint64_t &site_index) const;
+
+        /**
+         * Compares layouts and counts, regardless of counter width.
+         */
+        bool operator==(const SitesAlleleBaseCoverage &other) const;
+
+        bool operator!=(const SitesAlleleBaseCoverage &other) const { return not(*this == other); }
+
+    private:
+        BaseCoverageWidth counter_width = BaseCoverageWidth::bits32;
+        std::vector<uint64_t> site_offsets;
+        std::vector<uint64_t> allele_offsets;
+        // Only the array of the counter width is used.
+        std::vector<uint16_t> counters16;
+        std::vector<uint32_t> counters32;
+
+        template<typename Counter>
+        static void increment_counters(std::vector<Counter> &counters, const uint64_t &first, const uint64_t &last) {
+            for (uint64_t i = first; i < last; ++i) {
+                if (counters[i] != std::numeric_limits<Counter>::max())
+                    ++counters[i];
+            }
+        }
+    };
+
+    /**
+     * Prints the nested coverage of each site, for test failure messages.
+     */
+    std::ostream &operator<<(std::ostream &stream, const SitesAlleleBaseCoverage &sites);
 
     /**
      * Groups together all coverage metrics to record.
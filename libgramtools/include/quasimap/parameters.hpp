@@ -27,6 +27,11 @@ namespace gram::commands::quasimap {
      */
     Parameters parse_parameters(po::variables_map &vm,
                                 const po::parsed_options &parsed);
+
+    /**
+     * Parses a `--coverage-compression` value: "none" or "gzip".
+     */
+    OutputCompression parse_output_compression(const std::string &compression);
 }
 
 #endif //GRAMTOOLS_QUASIMAP_PARAMETERS_HPP
@@ -31,17 +31,25 @@ namespace gram {
                                       ReadStats &readstats);
 
     /**
-     * Load and process (ie map) reads from a given read file using a buffer to reduce disk I/O calls
+     * Load and process (ie map) reads from a given read file using a buffer to reduce disk I/O calls.
+     * Buffers of `reads_batch_size` reads are parsed by a reader thread while the previous ones are mapped;
+     * at most `reads_queue_depth` parsed buffers wait to be mapped.
+     * Gzip and BGZF compressed reads are decompressed on separate threads (@see DecompressionPipe).
+     * @param coverage_shards one `Coverage` per thread; each thread only records into its own.
+     * @param readstats records the length and base qualities of every read, as the reads are parsed.
      */
-    void handle_read_file(QuasimapReadsStats &quasimap_stats, Coverage &coverage, const std::string &reads_fpath,
+    void handle_read_file(QuasimapReadsStats &quasimap_stats, std::vector<Coverage> &coverage_shards,
+                          ReadStats &readstats, const std::string &reads_fpath,
                           const Parameters &parameters, const KmerIndex &kmer_index, const PRG_Info &prg_info);
 
     /**
      * Calls quasimapping routine on a given read (forward mapping), and its reverse complement (reverse mapping)
+     * @param read_id the read's position in the input; its forward and reverse mappings get ids `2 * read_id` and `2 * read_id + 1`.
      */
     void quasimap_forward_reverse(QuasimapReadsStats &quasimap_reads_stats,
                                   Coverage &coverage,
                                   const Pattern &read,
+                                  const uint64_t &read_id,
                                   const Parameters &parameters,
                                   const KmerIndex &kmer_index,
                                   const PRG_Info &prg_info);
@@ -51,10 +59,11 @@ namespace gram {
      * @param coverage object in which mapping statistics are recorded.
      * @param kmer_index object holding the pre-computed mappings for kmers. the first kmer in the read will be seeded this way.
      * @param prg_info object holding all data structures necessary for vBWT, including `gram::FM_Index`.
+     * @param read_id seeds the random stream choosing among multiple mappings, together with `parameters.seed`.
      * @return
      */
     bool quasimap_read(const Pattern &read, Coverage &coverage, const KmerIndex &kmer_index, const PRG_Info &prg_info,
-                       const Parameters &parameters);
+                       const Parameters &parameters, const uint64_t &read_id = 0);
 
     Pattern get_kmer_from_read(const uint32_t &kmer_size, const Pattern &read);
 
@@ -3,6 +3,8 @@
  * @note `char2comp` attribute of `fm_index` gives the lexicographic ordering of the queried symbol. This allows for
  * finding symbol's first occurrence in the SA using the `C` array. For eg, we do not assume that site marker '5' is
  * the 5th element of the `C` array, because we can be given a prg which can have discontinuous integers marking variant sites.
+ * These first occurrences are looked up once, when `gram::PRG_Info` is built (@see generate_dna_first_sa_indexes(),
+ * generate_sites_marker_info()), so that search does not need the `fm_index`.
  */
 #include "common/utils.hpp"
 #include "kmer_index/kmer_index_types.hpp"
@@ -50,6 +52,14 @@ namespace gram {
     SearchStates search_base_backwards(const Base &pattern_char,
                                        const SearchStates &search_states,
                                        const PRG_Info &prg_info);
+
+    /**
+     * @see search_base_backwards()
+     * Consumes `search_states`, updating them in place instead of copying each of them.
+     */
+    SearchStates search_base_backwards(const Base &pattern_char,
+                                       SearchStates &&search_states,
+                                       const PRG_Info &prg_info);
 using SaIndexRightOfMarker = uint64_t;
     using MarkersSearchResult = std::pair<SaIndexRightOfMarker, Marker>; /** SaIndexRightOfMarker is the SA index position of the character just right of the marker in the prg.*/
     using MarkersSearchResults = std::vector<MarkersSearchResult>;
@@ -68,7 +78,7 @@ using SaIndexRightOfMarker = uint64_t;
     /**
      * Update the current SA interval to include the next character.
      * This is a backward search. SA interval is updated using rank queries on the bwt.
-     * @param next_char the next character to look for.
+     * @param next_char the next character to look for: a DNA base.
      * @param next_char_first_sa_index the position of the first occurrence of `next_char` in the SA.
      */
     SA_Interval base_next_sa_interval(const Marker &next_char,
@@ -94,6 +104,14 @@ using SaIndexRightOfMarker = uint64_t;
                                                  const SearchStates &old_search_states,
                                                  const PRG_Info &prg_info);
 
+    /**
+     * @see process_read_char_search_states()
+     * Consumes `old_search_states`; used when mapping a read, where the previous search states are no longer needed.
+     */
+    SearchStates process_read_char_search_states(const Base &pattern_char,
+                                                 SearchStates &&old_search_states,
+                                                 const PRG_Info &prg_info);
+
     /**
     * Retrieve the allele id from an allele marker SA index.
     * The previous position in the original text is used to query the `allele_mask`, part of `PRG_Info`. It contains
@@ -121,6 +139,13 @@ using SaIndexRightOfMarker = uint64_t;
     SearchStates process_markers_search_states(const SearchStates &search_states,
                                                const PRG_Info &prg_info);
 
+    /**
+     * @see process_markers_search_states()
+     * Consumes `search_states`: the new `SearchState`s are appended to them without copying the existing ones.
+     */
+    SearchStates process_markers_search_states(SearchStates &&search_states,
+                                               const PRG_Info &prg_info);
+
     /**
      * For a given `SearchState`, add new `SearchState`s based on variant marker presence.
      * Variant markers are found by querying the BWT on the SA interval of the `SearchState`.
@@ -12,7 +12,7 @@ namespace gram {
      * Expresses the positioning of the current search state relative to variant sites.
      * Initialised at `unknown`.
      */
-    enum class SearchVariantSiteState {
+    enum class SearchVariantSiteState : uint8_t {
         within_variant_site,
         outside_variant_site,
         unknown
@@ -29,8 +29,6 @@ namespace gram {
         VariantSitePath variant_site_path = {}; /**< Stores the path taken through variant sites in the prg. */
         SearchVariantSiteState variant_site_state = SearchVariantSiteState::unknown;
 
-        bool invalid = false; /**< Represents whether no path is found in the prg. */
-
         bool operator==(const SearchState &other) const {
             return this->sa_interval == other.sa_interval
                    and this->variant_site_path == other.variant_site_path
@@ -38,7 +36,11 @@ namespace gram {
         };
     };
 
-    using SearchStates = std::list<SearchState>;
+    /**
+     * Search states are kept contiguous: the search extends, filters and appends them at every read base,
+     * so a vector avoids one heap allocation per state.
+     */
+    using SearchStates = std::vector<SearchState>;
 }
 
 #endif //GRAMTOOLS_SEARCH_TYPES_HPP
@@ -73,6 +73,21 @@ public:
         }
     }
 
+    /**
+     * Reads uncompressed FASTA/FASTQ from an open file descriptor, which is closed with the reader.
+     */
+    explicit SeqRead(int file_descriptor) {
+        read = seq_read_new();
+        file = seq_dopen(file_descriptor, 0, false, 1 << 20); // The buffer size of `seq_open`
+        if (file == NULL) {
+            seq_read_free(read);
+            printf("Unable to open file descriptor %i\n", file_descriptor);
+            exit(1);
+        } else {
+            gr = new GenomicRead();
+        }
+    }
+
     ~SeqRead() {
         seq_close(file);
         seq_read_free(read);
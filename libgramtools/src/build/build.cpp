@@ -3,6 +3,7 @@
 
 #include "prg/prg.hpp"
 #include "prg/masks.hpp"
+#include "prg/prg_bundle.hpp"
 
 #include "kmer_index/build.hpp"
 #include "kmer_index/dump.hpp"
@@ -17,6 +18,11 @@ void commands::build::run(const Parameters &parameters) {
     std::cout << "Executing build command" << std::endl;
     auto timer = TimerReport();
 
+    if (parameters.kmers_size > max_packed_kmer_size) {
+        std::cout << "Kmer size must be at most " << max_packed_kmer_size << ".\nExiting 1" << std::endl;
+        std::exit(1);
+    }
+
     PRG_Info prg_info;
 
     std::cout << "Generating integer encoded PRG" << std::endl;
@@ -37,11 +43,19 @@ void commands::build::run(const Parameters &parameters) {
     std::cout << "Generating FM-Index" << std::endl;
     timer.start("Generate FM-Index");
     prg_info.fm_index = generate_fm_index(parameters);
+    prg_info.sa_sampling_interval = parameters.sa_sampling_interval;
+    auto sa_samples = generate_suffix_array_samples(prg_info.fm_index, prg_info.sa_sampling_interval);
+    prg_info.suffix_array = std::move(sa_samples.suffix_array);
+    prg_info.sa_samples_mask = std::move(sa_samples.sa_samples_mask);
+    prg_info.sa_samples_rank = sdsl::rank_support_v<1>(&prg_info.sa_samples_mask);
+    prg_info.bwt_markers_sa = std::move(sa_samples.bwt_markers_sa);
+    prg_info.markers_sa = std::move(sa_samples.markers_sa);
+    prg_info.dna_first_sa_indexes = generate_dna_first_sa_indexes(prg_info.fm_index);
     timer.stop();
 
     std::cout << "Generating PRG masks" << std::endl;
     timer.start("Generating PRG masks");
-    generate_dna_bwt_masks(prg_info.fm_index, parameters);
+    prg_info.dna_bwt_occ = generate_dna_bwt_occ(prg_info.fm_index, parameters);
 
     prg_info.sites_mask = generate_sites_mask(prg_info.encoded_prg);
     sdsl::store_to_file(prg_info.sites_mask, parameters.sites_mask_fpath);
@@ -57,12 +71,17 @@ void commands::build::run(const Parameters &parameters) {
             prg_info.prg_markers_rank(prg_info.prg_markers_mask.size());
 
     prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers = generate_bwt_markers(prg_info.fm_index,
+                                                prg_info.bwt_markers_mask,
+                                                prg_info.markers_mask_count_set_bits);
+    prg_info.sites_marker_info = generate_sites_marker_info(prg_info.fm_index);
+    timer.stop();
 
-    prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index, parameters);
-    prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-    prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-    prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-    prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+    std::cout << "Writing PRG info bundle" << std::endl;
+    timer.start("Writing PRG info bundle");
+    dump_prg_info_bundle(prg_info, parameters);
     timer.stop();
 
     std::cout << "Building kmer index"
@@ -24,7 +24,10 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
                              ("max-threads", po::value<uint32_t>()->default_value(1),
                               "maximum number of threads used")
                              ("all-kmers", po::bool_switch()->default_value(false),
-                              "generate all kmers of given size (as opposed to inspecting PRG for min set)");
+                              "generate all kmers of given size (as opposed to inspecting PRG for min set)")
+                             ("sa-sampling-interval", po::value<uint32_t>()->default_value(1),
+                              "keep suffix array values for one in this many prg positions: "
+                              "larger intervals use less memory, but make locating prg positions slower");
 
     std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
                                                              po::include_positional);
@@ -42,6 +45,7 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
     parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
     parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
     parameters.sdsl_memory_log_fpath = full_path(gram_dirpath, "sdsl_memory_log");
+    parameters.prg_info_bundle_fpath = full_path(gram_dirpath, "prg_info");
 
     parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
     parameters.kmers_fpath = full_path(gram_dirpath, "kmers");
@@ -52,6 +56,9 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
     parameters.kmers_size = vm["kmer-size"].as<uint32_t>();
     parameters.max_read_size = vm["max-read-size"].as<uint32_t>();
     parameters.all_kmers_flag = vm["all-kmers"].as<bool>();
+    parameters.sa_sampling_interval = vm["sa-sampling-interval"].as<uint32_t>();
+    if (parameters.sa_sampling_interval == 0)
+        throw po::invalid_option_value(std::to_string(parameters.sa_sampling_interval));
     
     parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
     return parameters;
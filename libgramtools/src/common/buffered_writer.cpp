@@ -0,0 +1,77 @@
+#include <iostream>
+
+#include "common/buffered_writer.hpp"
+
+
+using namespace gram;
+
+
+/** Large enough that flushes are rare syscalls, small enough to be negligible next to the structures written. */
+constexpr uint64_t buffer_size = 1 << 20;
+
+
+std::string gram::compressed_fpath(const std::string &fpath, const OutputCompression &compression) {
+    if (compression == OutputCompression::gzip)
+        return fpath + ".gz";
+    return fpath;
+}
+
+
+BufferedWriter::BufferedWriter(const std::string &fpath, const OutputCompression &compression) : fpath(fpath),
+                                                                                                 buffer(buffer_size) {
+    if (compression == OutputCompression::gzip) {
+        // Fast compression: coverage outputs are repetitive and compress well even at the lowest level.
+        compressed_file = gzopen(fpath.c_str(), "wb1");
+        if (compressed_file != nullptr)
+            gzbuffer(compressed_file, buffer_size);
+    } else {
+        file = std::fopen(fpath.c_str(), "wb");
+    }
+
+    if (file == nullptr and compressed_file == nullptr) {
+        std::cout << "Problem opening file for writing: " << fpath << std::endl;
+        exit(1);
+    }
+}
+
+
+BufferedWriter::BufferedWriter(std::string &destination) : destination(&destination), buffer(buffer_size) {}
+
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+    bool closed = true;
+    if (file != nullptr)
+        closed = std::fclose(file) == 0;
+    if (compressed_file != nullptr)
+        closed = gzclose(compressed_file) == Z_OK;
+    if (not closed) {
+        std::cout << "Problem writing file: " << fpath << std::endl;
+        exit(1);
+    }
+}
+
+
+void BufferedWriter::flush() {
+    write_out(buffer.data(), used);
+    used = 0;
+}
+
+
+void BufferedWriter::write_out(const char *data, const uint64_t &size) {
+    if (size == 0)
+        return;
+
+    bool written = true;
+    if (destination != nullptr)
+        destination->append(data, size);
+    else if (file != nullptr)
+        written = std::fwrite(data, 1, size, file) == size;
+    else
+        written = gzfwrite(data, 1, size, compressed_file) == size;
+
+    if (not written) {
+        std::cout << "Problem writing file: " << fpath << std::endl;
+        exit(1);
+    }
+}
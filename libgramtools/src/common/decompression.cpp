@@ -0,0 +1,151 @@
+#include <cerrno>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "htslib/bgzf.h"
+
+#include "common/decompression.hpp"
+
+
+using namespace gram;
+
+
+CompressionFormat gram::detect_compression_format(const std::string &fpath) {
+    std::ifstream file(fpath, std::ios::binary);
+    if (not file) {
+        std::cout << "Problem opening file: " << fpath << std::endl;
+        exit(1);
+    }
+
+    unsigned char header[14] = {};
+    file.read((char *) header, sizeof(header));
+    auto count_read = file.gcount();
+
+    bool is_gzip = count_read >= 2 and header[0] == 0x1f and header[1] == 0x8b;
+    if (not is_gzip)
+        return CompressionFormat::none;
+
+    // A BGZF block is a deflate gzip member whose first extra subfield is 'BC'.
+    bool has_extra_field = count_read == sizeof(header) and header[2] == 8 and (header[3] & 4) != 0;
+    bool is_bgzf = has_extra_field and header[12] == 'B' and header[13] == 'C';
+    return is_bgzf ? CompressionFormat::bgzf : CompressionFormat::gzip;
+}
+
+
+/**
+ * Writes all of `data` to `descriptor`.
+ * @return false if the read end of the pipe has been closed.
+ */
+bool write_all(const int descriptor, const char *data, uint64_t size) {
+    while (size > 0) {
+        auto count_written = write(descriptor, data, size);
+        if (count_written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += count_written;
+        size -= count_written;
+    }
+    return true;
+}
+
+
+/**
+ * Copies decompressed chunks from `read_chunk` to `write_descriptor` until the input ends or the reader goes away.
+ */
+template<typename ReadChunk>
+void pipe_decompressed_chunks(ReadChunk read_chunk, const int write_descriptor, const std::string &fpath) {
+    // If the reader closes its end early, `write` fails with EPIPE rather than the process receiving SIGPIPE.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    const uint64_t chunk_size = 1 << 20;
+    std::vector<char> chunk(chunk_size);
+    while (true) {
+        int64_t count_read = read_chunk(chunk.data(), chunk_size);
+        if (count_read < 0) {
+            std::cout << "Problem decompressing file: " << fpath << std::endl;
+            exit(1);
+        }
+        if (count_read == 0)
+            break;
+        if (not write_all(write_descriptor, chunk.data(), (uint64_t) count_read))
+            break;
+    }
+    close(write_descriptor);
+}
+
+
+DecompressionPipe::DecompressionPipe(const std::string &fpath,
+                                     const CompressionFormat &compression_format,
+                                     const uint32_t &count_threads) {
+    int descriptors[2];
+    if (pipe(descriptors) != 0) {
+        std::cout << "Problem creating a pipe for decompressing: " << fpath << std::endl;
+        exit(1);
+    }
+    read_descriptor = descriptors[0];
+    int write_descriptor = descriptors[1];
+#ifdef F_SETPIPE_SZ
+    // A larger pipe lets the writer run further ahead of the parser; failure only leaves the default size.
+    fcntl(write_descriptor, F_SETPIPE_SZ, 1 << 20);
+#endif
+
+    if (compression_format == CompressionFormat::bgzf) {
+        BGZF *file = bgzf_open(fpath.c_str(), "r");
+        if (file == nullptr) {
+            std::cout << "Problem opening BGZF file: " << fpath << std::endl;
+            exit(1);
+        }
+        // htslib decompresses blocks on its own thread pool, ahead of the reads.
+        if (count_threads > 1)
+            bgzf_mt(file, (int) count_threads, 256);
+
+        writer = std::thread([file, fpath, descriptor = write_descriptor]() {
+            pipe_decompressed_chunks([file](char *chunk, const uint64_t &size) {
+                return (int64_t) bgzf_read(file, chunk, size);
+            }, descriptor, fpath);
+            bgzf_close(file);
+        });
+        return;
+    }
+
+    gzFile file = gzopen(fpath.c_str(), "r");
+    if (file == nullptr) {
+        std::cout << "Problem opening gzip file: " << fpath << std::endl;
+        exit(1);
+    }
+    gzbuffer(file, 1 << 20);
+    writer = std::thread([file, fpath, descriptor = write_descriptor]() {
+        pipe_decompressed_chunks([file](char *chunk, const uint64_t &size) {
+            return (int64_t) gzread(file, chunk, (unsigned) size);
+        }, descriptor, fpath);
+        gzclose(file);
+    });
+}
+
+
+DecompressionPipe::~DecompressionPipe() {
+    // Closing an unreleased read end lets the writer stop.
+    if (read_descriptor >= 0)
+        close(read_descriptor);
+    if (writer.joinable())
+        writer.join();
+}
+
+
+int DecompressionPipe::release_read_descriptor() {
+    auto descriptor = read_descriptor;
+    read_descriptor = -1;
+    return descriptor;
+}
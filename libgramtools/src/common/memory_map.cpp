@@ -0,0 +1,52 @@
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/memory_map.hpp"
+
+
+using namespace gram;
+
+
+MemoryMap::MemoryMap(const std::string &fpath) {
+    int file_descriptor = open(fpath.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        std::cout << "Problem opening file for mapping: " << fpath << std::endl;
+        exit(1);
+    }
+
+    struct stat file_stats = {};
+    if (fstat(file_descriptor, &file_stats) != 0) {
+        close(file_descriptor);
+        std::cout << "Problem reading file size for mapping: " << fpath << std::endl;
+        exit(1);
+    }
+    length = (uint64_t) file_stats.st_size;
+
+    // An empty file cannot be mapped; it is viewed as an empty region.
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, file_descriptor, 0);
+        if (mapped == MAP_FAILED) {
+            close(file_descriptor);
+            std::cout << "Problem mapping file: " << fpath << std::endl;
+            exit(1);
+        }
+        address = (const char *) mapped;
+    }
+    // The mapping outlives the file descriptor.
+    close(file_descriptor);
+}
+
+
+MemoryMap::~MemoryMap() {
+    if (address != nullptr)
+        munmap((void *) address, length);
+}
+
+
+MemoryMapPtr gram::map_file(const std::string &fpath) {
+    return std::make_shared<const MemoryMap>(fpath);
+}
@@ -1,95 +1,70 @@
 #include "common/read_stats.hpp"
 #include <math.h>
+#include <cstring>
 
 using namespace gram;
 
-void gram::ReadStats::compute_base_error_rate(const std::string &reads_fpath){
+void gram::ReadStats::record_read(const GenomicRead &read){
 
-    // The number of reads (with at least one base with recorded quality) to estimate from.
-    // Is defined in the header file.
-    uint64_t required_reads = NUM_READS_USED;
-    uint64_t num_informative_reads = 0;
+    // Test for max read length
+    auto sequence_length = strlen(read.seq);
+    if (sequence_length > this->max_read_length) this->max_read_length = sequence_length;
 
-    int64_t no_qual_reads = 0;
-    int64_t num_bases_processed = 0;
-    double mean_error = 0;
-
-    float running_qual_score = 0.0;
-
-    SeqRead reads(reads_fpath.c_str());
-    SeqRead::SeqIterator reads_it = reads.begin();
-
-    while (num_informative_reads < required_reads and reads_it != reads.end()){
-
-        auto *const raw_read = *reads_it;
-
-        // Test for max read length
-        std::string sequence = std::string(raw_read->seq);
-        auto sequence_length = sequence.length();
-        if (sequence_length > this->max_read_length) this->max_read_length = sequence_length;
-
-
-        // Process quality scores
-        std::string qualities = std::string(raw_read->qual);
+    // Process quality scores
+    auto qualities_length = read.qual == nullptr ? 0 : strlen(read.qual);
+    if (qualities_length == 0){
+        no_qual_reads++;
+        return;
+    }
 
-        if (qualities.length() == 0){ //We will keep looking for reads with quality scored bases.
-            no_qual_reads++ ;
-            ++reads_it;
-            continue;
-        }
+    for (uint64_t i = 0; i < qualities_length; ++i){
+        total_qual_score += (read.qual[i] - 33); // Assuming +33 Phred-scoring
+    }
+    num_bases_processed += qualities_length;
+};
 
 
-        for (const auto base:qualities){
-            running_qual_score += (base - 33); // Assuming +33 Phred-scoring
-            num_bases_processed++;
-        }
+void gram::ReadStats::add_read_stats(const ReadStats &other){
+    if (other.max_read_length > this->max_read_length) this->max_read_length = other.max_read_length;
+    this->no_qual_reads += other.no_qual_reads;
+    this->num_bases_processed += other.num_bases_processed;
+    this->total_qual_score += other.total_qual_score;
+};
 
-        num_informative_reads++;
-        ++reads_it;
-    }
 
+void gram::ReadStats::compute_base_error_rate(){
+    double mean_error = 0;
     if (num_bases_processed > 0){
-        double mean_qual = running_qual_score / num_bases_processed;
+        double mean_qual = total_qual_score / num_bases_processed;
         mean_error = pow(10, -mean_qual/10);
     }
-
-    this->num_bases_processed = num_bases_processed;
-    this->no_qual_reads = no_qual_reads;
     this->mean_error = mean_error;
 };
 
-void gram::ReadStats::compute_coverage_depth(gram::Coverage &coverage) {
-    std::vector<uint64_t> coverages;
-    uint64_t this_site_cov;
-    double total_coverage = 0;
-    int64_t num_sites_noCov = 0;
-    int64_t num_sites_total = 0;
 
-    double mean_coverage, variance_coverage;
-
-    for (const auto& site : coverage.grouped_allele_counts){ //`site` is an unordered_map associating alleleIDs with coverage.
-
-        num_sites_total++;
-        this_site_cov = 0;
+void gram::ReadStats::compute_coverage_depth(const gram::Coverage &coverage) {
+    // Welford's online update gives the mean and variance in one pass, without storing each site's depth
+    // and without the cancellation of subtracting the squared mean from the mean square.
+    double mean_coverage = 0;
+    double sum_squared_deviations = 0;
+    int64_t num_sites_noCov = 0;
+    int64_t num_sites_total = coverage.grouped_allele_counts.size();
 
+    int64_t num_sites_seen = 0;
+    for (const auto& site : coverage.grouped_allele_counts){ //`site` maps allele groups to coverage.
+        uint64_t this_site_cov = 0;
         for (const auto& entry : site){
             this_site_cov += entry.second;
         }
 
-        coverages.push_back(this_site_cov);
-        total_coverage += this_site_cov;
+        ++num_sites_seen;
+        double deviation = this_site_cov - mean_coverage;
+        mean_coverage += deviation / num_sites_seen;
+        sum_squared_deviations += deviation * (this_site_cov - mean_coverage);
         if (this_site_cov == 0) num_sites_noCov++;
     }
 
-    // Compute mean
-    mean_coverage = total_coverage / coverages.size();
-
-    // Compute variance
-    double total_variance = 0;
-    for (const auto& site_cov : coverages){
-       total_variance += pow((site_cov - mean_coverage), 2);
-    }
-    variance_coverage = total_variance / coverages.size();
+    double variance_coverage = sum_squared_deviations / num_sites_total;
 
     // And record it all at the object level.
     this->mean_depth = mean_coverage;
@@ -1,6 +1,7 @@
 #include <algorithm>
-#include <thread>
-#include <unordered_map>
+#include <iterator>
+
+#include <omp.h>
 
 #include "search/search.hpp"
 #include "kmer_index/load.hpp"
@@ -28,7 +29,7 @@ CacheElement get_next_cache_element(const Base &base,
         new_search_states = old_search_states;
     }
     new_search_states = search_base_backwards(base,
-                                              new_search_states,
+                                              std::move(new_search_states),
                                               prg_info);
     return CacheElement{
             new_search_states,
@@ -60,16 +61,18 @@ CacheElement get_initial_cache_element(const Base &base,
 
 /**
  * Routine for updating `SearchStates` using backward search starting from the `cache`
- * @param cache a `KmerIndexCache`: list of `CacheElement`s, which contain one set of `SearchStates` and one `Base`
+ * @param cache a `KmerIndexCache`: list of `CacheElement`s, which contain one set of `SearchStates` and one `Base`
  * @param full_kmer: a `Pattern`, which is a vector of `Base`s (`uint8`s)
+ * @param prefix_diff_length: the number of leading bases of `full_kmer` which differ from the previous kmer.
  */
 void build_kmer_cache(KmerIndexCache &cache,
-                      const Pattern &kmer_prefix_diff,
-                      const int kmer_size,
+                      const Pattern &full_kmer,
+                      const uint64_t prefix_diff_length,
+                      const uint64_t kmer_size,
                       const PRG_Info &prg_info) {
-    auto it = kmer_prefix_diff.rbegin();
+    auto it = full_kmer.rend() - prefix_diff_length;
 
-    if (kmer_prefix_diff.size() == kmer_size) {
+    if (prefix_diff_length == kmer_size) {
     // Case: a fully new kmer is encountered. No reuse of `cache`d search possible. Call a full search on the kmer.
         const auto &base = *it;
         cache.resize(0); // Empty the `cache`
@@ -79,11 +82,11 @@ void build_kmer_cache(KmerIndexCache &cache,
     }
 
     else {
-        const auto preserved_cache_size = kmer_size - kmer_prefix_diff.size();
+        const auto preserved_cache_size = kmer_size - prefix_diff_length;
         cache.resize(preserved_cache_size);
     }
 
-    for (; it != kmer_prefix_diff.rend(); ++it) {
+    for (; it != full_kmer.rend(); ++it) {
         const auto &base = *it;
         // the right-most kmer base (first processed) is only ever handled by `get_initial_cache_element`
         const bool kmer_base_is_first_processed = false;
@@ -113,56 +116,147 @@ void update_full_kmer(Pattern &full_kmer,
         full_kmer[start_idx++] = base;
 }
 
-KmerIndex gram::index_kmers(const Patterns &kmer_prefix_diffs,
-                            const int kmer_size,
-                            const PRG_Info &prg_info) {
-    KmerIndex kmer_index;
+std::vector<KmerPartition> gram::get_kmer_partitions(const std::vector<uint8_t> &prefix_diff_lengths,
+                                                      const int kmer_size,
+                                                      const uint64_t &count_partitions) {
+    std::vector<KmerPartition> partitions;
+    if (prefix_diff_lengths.empty())
+        return partitions;
+
+    const uint64_t target_size = std::max<uint64_t>(1, prefix_diff_lengths.size() / std::max<uint64_t>(1, count_partitions));
+    KmerPartition partition = {0, 0};
+    for (uint64_t i = 1; i < prefix_diff_lengths.size(); ++i) {
+        // A full kmer resets the cache: the kmers from there on do not depend on the ones before.
+        bool is_full_kmer = prefix_diff_lengths[i] == kmer_size;
+        if (is_full_kmer and i - partition.first >= target_size) {
+            partition.second = i;
+            partitions.push_back(partition);
+            partition.first = i;
+        }
+    }
+    partition.second = prefix_diff_lengths.size();
+    partitions.push_back(partition);
+    return partitions;
+}
+
+/**
+ * Indexes the kmers of one partition, with its own `KmerIndexCache`.
+ * @return the `KmerIndexEntry` of each kmer found in the prg.
+ */
+KmerIndexEntries index_kmer_partition(const PackedKmers &reverse_kmers,
+                                      const std::vector<uint8_t> &prefix_diff_lengths,
+                                      const KmerPartition &partition,
+                                      const int kmer_size,
+                                      const PRG_Info &prg_info) {
+    KmerIndexEntries entries;
     KmerIndexCache cache;
-    Pattern full_kmer;
 
-    auto total_num_kmers = kmer_prefix_diffs.size();
+    for (uint64_t i = partition.first; i < partition.second; ++i) {
+        // Obtain the full kmer, as seen in the prg, from its packed reverse
+        auto full_kmer = unpack_kmer(reverse_kmers[i], kmer_size);
+        std::reverse(full_kmer.begin(), full_kmer.end());
+
+        // Call cache update routine
+        build_kmer_cache(cache,
+                         full_kmer,
+                         prefix_diff_lengths[i],
+                         kmer_size,
+                         prg_info);
+
+        // Associate the current kmer with the resulting `SearchStates`, if they are not empty.
+        const auto &last_cache_element = cache.back();
+        if (not last_cache_element.search_states.empty())
+            entries.emplace_back(pack_kmer(full_kmer), last_cache_element.search_states);
+    }
+    return entries;
+}
+
+/**
+ * Indexes packed reverse kmers, given the length of each kmer's prefix diff.
+ */
+KmerIndex index_reverse_kmers(const PackedKmers &reverse_kmers,
+                              const std::vector<uint8_t> &prefix_diff_lengths,
+                              const int kmer_size,
+                              const PRG_Info &prg_info) {
+    auto total_num_kmers = reverse_kmers.size();
     std::cout << "Total number of unique kmers: "
               << total_num_kmers
               << std::endl << std::endl;
 
-    auto count = 0;
-    for (const auto &kmer_prefix_diff: kmer_prefix_diffs) {
-        if (count > 0 and count % 50000 == 0)
+    // Several partitions per thread balance the load between threads.
+    const uint64_t partitions_per_thread = 8;
+    const auto partitions = get_kmer_partitions(prefix_diff_lengths,
+                                                kmer_size,
+                                                omp_get_max_threads() * partitions_per_thread);
+    std::vector<KmerIndexEntries> partitions_entries(partitions.size());
+
+    uint64_t count = 0;
+    #pragma omp parallel for schedule(dynamic)
+    for (uint64_t i = 0; i < partitions.size(); ++i) {
+        partitions_entries[i] = index_kmer_partition(reverse_kmers,
+                                                     prefix_diff_lengths,
+                                                     partitions[i],
+                                                     kmer_size,
+                                                     prg_info);
+        #pragma omp critical
+        {
+            count += partitions[i].second - partitions[i].first;
             std::cout << "Progress: "
                       << count << " of " << total_num_kmers
                       << std::endl;
-        count++;
+        }
+    }
+
+    KmerIndexEntries entries;
+    uint64_t count_entries = 0;
+    for (const auto &partition_entries: partitions_entries)
+        count_entries += partition_entries.size();
+    entries.reserve(count_entries);
+    for (auto &partition_entries: partitions_entries) {
+        std::move(partition_entries.begin(), partition_entries.end(), std::back_inserter(entries));
+        KmerIndexEntries().swap(partition_entries);
+    }
+    return KmerIndex(kmer_size, std::move(entries));
+}
+
+KmerIndex gram::index_kmers(const PackedKmers &reverse_kmers,
+                            const int kmer_size,
+                            const PRG_Info &prg_info) {
+    const auto prefix_diff_lengths = get_prefix_diff_lengths(reverse_kmers, kmer_size);
+    return index_reverse_kmers(reverse_kmers, prefix_diff_lengths, kmer_size, prg_info);
+}
+
+KmerIndex gram::index_kmers(const Patterns &kmer_prefix_diffs,
+                            const int kmer_size,
+                            const PRG_Info &prg_info) {
+    PackedKmers reverse_kmers;
+    std::vector<uint8_t> prefix_diff_lengths;
+    reverse_kmers.reserve(kmer_prefix_diffs.size());
+    prefix_diff_lengths.reserve(kmer_prefix_diffs.size());
 
+    Pattern full_kmer;
+    for (const auto &kmer_prefix_diff: kmer_prefix_diffs) {
         // Obtain the full kmer from the previous kmer and the current prefix_diff
         update_full_kmer(full_kmer,
                          kmer_prefix_diff,
                          kmer_size);
-
-        // Call cache update routine
-        build_kmer_cache(cache,
-                         kmer_prefix_diff,
-                         kmer_size,
-                         prg_info);
-
-        // Associate the current kmer with the resulting `SearchStates`, if they are not empty.
-        const auto &last_cache_element = cache.back();
-        if (not last_cache_element.search_states.empty())
-            kmer_index[full_kmer] = last_cache_element.search_states;
+        reverse_kmers.push_back(pack_kmer(Pattern(full_kmer.rbegin(), full_kmer.rend())));
+        prefix_diff_lengths.push_back(kmer_prefix_diff.size());
     }
-    return kmer_index;
+    return index_reverse_kmers(reverse_kmers, prefix_diff_lengths, kmer_size, prg_info);
 }
 
 /**
  * Highest level indexing routine.
- * @see get_kmer_prefix_diffs()
+ * @see get_all_reverse_kmers()
  * @see index_kmers()
  */
 KmerIndex gram::kmer_index::build(const Parameters &parameters,
                                   const PRG_Info &prg_info) {
-    // Extract all relevant kmers and generate the minimal differences between them.
-    Patterns kmer_prefix_diffs = get_all_kmer_and_compute_prefix_diffs(parameters,
-                                                                       prg_info);
+    // Extract all relevant kmers, packed and sorted in reverse; the minimal differences between them follow from the packing.
+    std::cout << "Getting all kmers" << std::endl;
+    PackedKmers reverse_kmers = get_all_reverse_kmers(parameters, prg_info);
     std::cout << "Indexing kmers" << std::endl;
-    KmerIndex kmer_index = index_kmers(kmer_prefix_diffs, parameters.kmers_size, prg_info);
+    KmerIndex kmer_index = index_kmers(reverse_kmers, parameters.kmers_size, prg_info);
     return kmer_index;
 }
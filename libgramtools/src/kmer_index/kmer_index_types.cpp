@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cassert>
+
+#include "kmer_index/kmer_index_types.hpp"
+
+
+using namespace gram;
+
+
+PackedKmer gram::pack_kmer(const Pattern &kmer) {
+    assert(kmer.size() <= max_packed_kmer_size);
+    PackedKmer packed_kmer = 0;
+    for (const auto &base: kmer) {
+        assert(base >= 1 and base <= 4);
+        packed_kmer = (packed_kmer << 2) | (PackedKmer) (base - 1);
+    }
+    return packed_kmer;
+}
+
+
+Pattern gram::unpack_kmer(const PackedKmer &packed_kmer, const uint32_t &kmer_size) {
+    Pattern kmer(kmer_size);
+    auto remaining = packed_kmer;
+    for (auto it = kmer.rbegin(); it != kmer.rend(); ++it) {
+        *it = (Base) ((remaining & 3) + 1);
+        remaining >>= 2;
+    }
+    return kmer;
+}
+
+
+Patterns gram::unpack_kmers(const PackedKmers &packed_kmers, const uint32_t &kmer_size) {
+    Patterns kmers;
+    kmers.reserve(packed_kmers.size());
+    for (const auto &packed_kmer: packed_kmers)
+        kmers.emplace_back(unpack_kmer(packed_kmer, kmer_size));
+    return kmers;
+}
+
+
+KmerIndex::KmerIndex(const uint32_t &kmer_size, KmerIndexEntries entries) : kmer_size(kmer_size) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const KmerIndexEntry &lhs, const KmerIndexEntry &rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
+    uint64_t count_search_states = 0;
+    uint64_t count_path_elements = 0;
+    for (const auto &entry: entries) {
+        count_search_states += entry.second.size();
+        for (const auto &search_state: entry.second)
+            count_path_elements += search_state.variant_site_path.size();
+    }
+    kmers.reserve(entries.size());
+    search_states_offsets.reserve(entries.size() + 1);
+    sa_intervals.reserve(count_search_states);
+    variant_site_states.reserve(count_search_states);
+    paths_offsets.reserve(count_search_states + 1);
+    paths.reserve(count_path_elements);
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        // A repeated kmer keeps the last entry, as an assignment into a map would.
+        auto next = std::next(it);
+        if (next != entries.end() and next->first == it->first)
+            continue;
+
+        kmers.push_back(it->first);
+        for (const auto &search_state: it->second) {
+            sa_intervals.push_back(search_state.sa_interval);
+            variant_site_states.push_back(search_state.variant_site_state);
+            paths.insert_back(search_state.variant_site_path.begin(),
+                              search_state.variant_site_path.end());
+            paths_offsets.push_back(paths.size());
+        }
+        search_states_offsets.push_back(sa_intervals.size());
+    }
+}
+
+
+KmerIndex::KmerIndex(std::initializer_list<std::pair<Pattern, SearchStates>> entries) {
+    KmerIndexEntries packed_entries;
+    packed_entries.reserve(entries.size());
+    for (const auto &entry: entries) {
+        kmer_size = entry.first.size();
+        packed_entries.emplace_back(pack_kmer(entry.first), entry.second);
+    }
+    *this = KmerIndex(kmer_size, std::move(packed_entries));
+}
+
+
+uint64_t KmerIndex::find(const PackedKmer &packed_kmer) const {
+    if (not direct_lookup.empty()) {
+        const auto &kmer_position = direct_lookup[packed_kmer];
+        return kmer_position == direct_lookup_absent ? npos : kmer_position;
+    }
+
+    auto it = std::lower_bound(kmers.begin(), kmers.end(), packed_kmer);
+    if (it == kmers.end() or *it != packed_kmer)
+        return npos;
+    return (uint64_t) (it - kmers.begin());
+}
+
+
+uint64_t KmerIndex::find(const Pattern &kmer) const {
+    if (kmer.size() != kmer_size or kmer.size() > max_packed_kmer_size)
+        return npos;
+    return find(pack_kmer(kmer));
+}
+
+
+SearchStates KmerIndex::search_states(const uint64_t &kmer_position) const {
+    const auto &first = search_states_offsets[kmer_position];
+    const auto &last = search_states_offsets[kmer_position + 1];
+
+    SearchStates search_states;
+    search_states.reserve(last - first);
+    for (uint64_t i = first; i < last; ++i) {
+        search_states.emplace_back(SearchState{
+                sa_intervals[i],
+                VariantSitePath(paths.begin() + paths_offsets[i],
+                                paths.begin() + paths_offsets[i + 1]),
+                variant_site_states[i]
+        });
+    }
+    return search_states;
+}
+
+
+SearchStates KmerIndex::operator[](const Pattern &kmer) const {
+    auto kmer_position = find(kmer);
+    if (kmer_position == npos)
+        return SearchStates{};
+    return search_states(kmer_position);
+}
+
+
+bool KmerIndex::operator==(const KmerIndex &other) const {
+    return this->kmer_size == other.kmer_size
+           and this->kmers == other.kmers
+           and this->search_states_offsets == other.search_states_offsets
+           and this->sa_intervals == other.sa_intervals
+           and this->variant_site_states == other.variant_site_states
+           and this->paths_offsets == other.paths_offsets
+           and this->paths == other.paths;
+}
+
+
+void KmerIndex::build_direct_lookup() {
+    assert(kmer_size <= max_direct_lookup_kmer_size);
+    direct_lookup.assign((uint64_t) 1 << (2 * kmer_size), direct_lookup_absent);
+    // Read only: the kmers may be a view of the mapped kmer index file.
+    const auto &packed_kmers = kmers;
+    for (uint64_t i = 0; i < packed_kmers.size(); ++i)
+        direct_lookup[packed_kmers[i]] = (uint32_t) i;
+}
+
+
+bool gram::use_direct_lookup(const uint32_t &kmer_size, const uint64_t &prg_size) {
+    if (kmer_size > max_direct_lookup_kmer_size)
+        return false;
+    const uint64_t table_size = (uint64_t) 1 << (2 * kmer_size);
+    return table_size <= 4 * prg_size;
+}
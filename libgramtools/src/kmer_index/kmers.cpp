@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <iterator>
+
+#include <omp.h>
+
+#include "kmer_index/kmer_index_types.hpp"
 #include "kmer_index/kmers.hpp"
 
 
@@ -645,20 +651,6 @@ bool gram::update_allele_index_path(std::vector<uint64_t> &current_allele_index_
 }
 
 
-/**
- * Count the maximum number of different kmers to index to produce.
- * Based on multiplying each variant site's number of alleles.
- */
-uint64_t total_number_paths(const std::list<Patterns> &region_parts) {
-    uint64_t number_of_paths_expected = 1;
-    for (const auto &ordered_alleles: region_parts) {
-        uint64_t number_of_alleles = ordered_alleles.size();
-        number_of_paths_expected *= number_of_alleles;
-    }
-    return number_of_paths_expected;
-}
-
-
 unordered_vector_set<Pattern> gram::get_path_reverse_kmers(const Pattern &path,
                                                            const uint64_t &kmer_size) {
     unordered_vector_set<Pattern> reverse_kmers;
@@ -673,42 +665,59 @@ unordered_vector_set<Pattern> gram::get_path_reverse_kmers(const Pattern &path,
 }
 
 
+/**
+ * Adds the reverse of each kmer of `junction` starting before `tail_size`, ie each kmer overlapping both
+ * the tail of a walk and the allele appended to it.
+ */
+void add_junction_reverse_kmers(unordered_vector_set<Pattern> &reverse_kmers,
+                                const Pattern &junction,
+                                const uint64_t &tail_size,
+                                const uint64_t &kmer_size) {
+    for (uint64_t start = 0; start < tail_size and start + kmer_size <= junction.size(); ++start) {
+        Pattern reverse_kmer(junction.rend() - start - kmer_size, junction.rend() - start);
+        reverse_kmers.insert(reverse_kmer);
+    }
+}
+
+
 unordered_vector_set<Pattern> gram::get_region_parts_reverse_kmers(const std::list<Patterns> &region_parts,
                                                                    const uint64_t &kmer_size) {
-    uint64_t number_of_paths_expected = total_number_paths(region_parts);
-    std::vector<uint64_t> current_allele_index_path(region_parts.size(), 0); // Start at index 0 for each part of `region_parts`.
-    std::vector<uint64_t> parts_allele_counts; // Stores the number of alleles for each part of `region_parts`
-    parts_allele_counts.reserve(region_parts.size());
-    for (const auto &ordered_alleles: region_parts)
-        parts_allele_counts.push_back(ordered_alleles.size());
-
     unordered_vector_set<Pattern> all_reverse_kmers;
-    uint64_t count_paths = 0;
-
-    while (count_paths < number_of_paths_expected) {
-        if (count_paths > 0 and count_paths % 1000000 == 0) {
-            std::cout << "Processed paths: " << count_paths
-                      << ", total expected: " << number_of_paths_expected
-                      << std::endl;
-        }
-
-        Pattern path;
-        uint64_t i = 0;
-        for (const auto &ordered_alleles: region_parts) {
-            auto allele_index = current_allele_index_path[i];
-            const auto &allele = ordered_alleles[allele_index];
-            path.insert(path.end(), allele.begin(), allele.end());
-            i++;
+    if (kmer_size == 0)
+        return all_reverse_kmers;
+    const uint64_t max_tail_size = kmer_size - 1;
+
+    // Walks through the region parts are not enumerated. Instead, only the distinct tails of the walks so far
+    // (their last `kmer_size - 1` bases, or fewer near the region start) are kept: a kmer ending in an allele
+    // lies within that allele or overlaps a tail, so the tails are all that is needed of the walks leading to it.
+    unordered_vector_set<Pattern> tails = {Pattern{}};
+    for (const auto &ordered_alleles: region_parts) {
+        unordered_vector_set<Pattern> next_tails;
+        for (const auto &allele: ordered_alleles) {
+            // Kmers within the allele are the same whichever walk leads to it.
+            if (allele.size() >= kmer_size) {
+                auto allele_reverse_kmers = get_path_reverse_kmers(allele, kmer_size);
+                all_reverse_kmers.insert(allele_reverse_kmers.begin(), allele_reverse_kmers.end());
+            }
+
+            auto allele_spans_tail = allele.size() >= max_tail_size;
+            if (allele_spans_tail)
+                next_tails.insert(Pattern(allele.end() - max_tail_size, allele.end()));
+
+            const auto count_junction_allele_bases = std::min<uint64_t>(allele.size(), max_tail_size);
+            for (const auto &tail: tails) {
+                Pattern junction = tail;
+                junction.insert(junction.end(), allele.begin(), allele.begin() + count_junction_allele_bases);
+                add_junction_reverse_kmers(all_reverse_kmers, junction, tail.size(), kmer_size);
+
+                if (allele_spans_tail)
+                    continue;
+                // `junction` holds the whole allele: the next tail is its end.
+                auto next_tail_size = std::min<uint64_t>(junction.size(), max_tail_size);
+                next_tails.insert(Pattern(junction.end() - next_tail_size, junction.end()));
+            }
         }
-
-        auto reverse_kmers = get_path_reverse_kmers(path, kmer_size);
-        all_reverse_kmers.insert(reverse_kmers.begin(), reverse_kmers.end());
-        ++count_paths;
-
-        bool more_paths_possible = update_allele_index_path(current_allele_index_path,
-                                                            parts_allele_counts);
-        if (not more_paths_possible)
-            break;
+        tails = std::move(next_tails);
     }
     return all_reverse_kmers;
 }
@@ -854,8 +863,75 @@ std::vector<PrgIndexRange> gram::combine_overlapping_regions(const std::vector<P
 }
 
 
-ordered_vector_set<Pattern> gram::get_prg_reverse_kmers(const Parameters &parameters,
-                                                        const PRG_Info &prg_info) {
+void gram::sort_packed_kmers(PackedKmers &packed_kmers, const uint32_t &kmer_size) {
+    constexpr uint32_t digit_bits = 8;
+    constexpr uint64_t count_digit_values = (uint64_t) 1 << digit_bits;
+    const uint32_t count_passes = (2 * kmer_size + digit_bits - 1) / digit_bits;
+
+    PackedKmers buffer(packed_kmers.size());
+    std::vector<std::vector<uint64_t>> thread_offsets;
+
+    for (uint32_t pass = 0; pass < count_passes; ++pass) {
+        const uint32_t shift = pass * digit_bits;
+        #pragma omp parallel
+        {
+            #pragma omp single
+            thread_offsets.assign((uint64_t) omp_get_num_threads(), std::vector<uint64_t>(count_digit_values, 0));
+            auto &offsets = thread_offsets[omp_get_thread_num()];
+
+            // Each thread counts the digits of a contiguous block of kmers...
+            #pragma omp for schedule(static)
+            for (uint64_t i = 0; i < packed_kmers.size(); ++i)
+                ++offsets[(packed_kmers[i] >> shift) & (count_digit_values - 1)];
+
+            // ...the counts become each thread's starting offset per digit, in digit then thread order...
+            #pragma omp single
+            {
+                uint64_t offset = 0;
+                for (uint64_t digit = 0; digit < count_digit_values; ++digit) {
+                    for (auto &counts: thread_offsets) {
+                        auto count = counts[digit];
+                        counts[digit] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            // ...and each thread scatters the same block, keeping the sort stable.
+            #pragma omp for schedule(static)
+            for (uint64_t i = 0; i < packed_kmers.size(); ++i)
+                buffer[offsets[(packed_kmers[i] >> shift) & (count_digit_values - 1)]++] = packed_kmers[i];
+        }
+        packed_kmers.swap(buffer);
+    }
+    packed_kmers.erase(std::unique(packed_kmers.begin(), packed_kmers.end()), packed_kmers.end());
+}
+
+
+std::vector<uint8_t> gram::get_prefix_diff_lengths(const PackedKmers &reverse_kmers, const uint32_t &kmer_size) {
+    std::vector<uint8_t> prefix_diff_lengths(reverse_kmers.size());
+    if (reverse_kmers.empty())
+        return prefix_diff_lengths;
+
+    // Unused high bits of packed kmers are zero, and are not counted as leading zeros.
+    const uint32_t unused_bits = 64 - 2 * kmer_size;
+    prefix_diff_lengths[0] = kmer_size;
+    for (uint64_t i = 1; i < reverse_kmers.size(); ++i) {
+        auto differing_bits = reverse_kmers[i] ^ reverse_kmers[i - 1];
+        if (differing_bits == 0) {
+            prefix_diff_lengths[i] = 0;
+            continue;
+        }
+        // The first base of a reverse kmer is the last base of the kmer.
+        auto count_shared_bases = (__builtin_clzll(differing_bits) - unused_bits) / 2;
+        prefix_diff_lengths[i] = kmer_size - count_shared_bases;
+    }
+    return prefix_diff_lengths;
+}
+
+
+PackedKmers gram::get_prg_reverse_kmers(const Parameters &parameters,
+                                        const PRG_Info &prg_info) {
     auto boundary_marker_indexes = get_boundary_marker_indexes(prg_info);
     auto kmer_region_ranges = get_kmer_region_ranges(boundary_marker_indexes,
                                                      parameters.max_read_size,
@@ -863,20 +939,51 @@ ordered_vector_set<Pattern> gram::get_prg_reverse_kmers(const Parameters &parame
     // Merge all overlaps, so that we do not have redundancies in regions of the prg to index.
     kmer_region_ranges = combine_overlapping_regions(kmer_region_ranges);
 
-    // this data structure orders the kmers
-    ordered_vector_set<Pattern> all_kmers = {};
-    for (const auto &kmer_region_range: kmer_region_ranges) {
-        auto reverse_kmers = get_region_range_reverse_kmers(kmer_region_range,
+    // Regions do not overlap, so their kmers are enumerated independently, and packed as soon as they are found.
+    std::vector<PackedKmers> regions_reverse_kmers(kmer_region_ranges.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (uint64_t i = 0; i < kmer_region_ranges.size(); ++i) {
+        auto reverse_kmers = get_region_range_reverse_kmers(kmer_region_ranges[i],
                                                             parameters.kmers_size,
                                                             prg_info);
-        all_kmers.insert(reverse_kmers.begin(), reverse_kmers.end());
+        auto &region_reverse_kmers = regions_reverse_kmers[i];
+        region_reverse_kmers.reserve(reverse_kmers.size());
+        for (const auto &reverse_kmer: reverse_kmers)
+            region_reverse_kmers.push_back(pack_kmer(reverse_kmer));
     }
-    return all_kmers;
+
+    uint64_t count_reverse_kmers = 0;
+    for (const auto &region_reverse_kmers: regions_reverse_kmers)
+        count_reverse_kmers += region_reverse_kmers.size();
+    PackedKmers reverse_kmers;
+    reverse_kmers.reserve(count_reverse_kmers);
+    for (auto &region_reverse_kmers: regions_reverse_kmers) {
+        reverse_kmers.insert(reverse_kmers.end(), region_reverse_kmers.begin(), region_reverse_kmers.end());
+        PackedKmers().swap(region_reverse_kmers);
+    }
+    // The same kmer can occur in several regions; sorting removes repeats.
+    sort_packed_kmers(reverse_kmers, parameters.kmers_size);
+    return reverse_kmers;
 }
 
 
-std::vector<Pattern> gram::reverse(const ordered_vector_set<Pattern> &reverse_kmers) {
+PackedKmers gram::get_all_reverse_kmers(const Parameters &parameters,
+                                        const PRG_Info &prg_info) {
+    if (parameters.all_kmers_flag) {
+        // The reverses of all kmers are all kmers, which packed kmers enumerate in order.
+        const uint64_t count_kmers = (uint64_t) 1 << (2 * parameters.kmers_size);
+        PackedKmers all_reverse_kmers(count_kmers);
+        for (PackedKmer packed_kmer = 0; packed_kmer < count_kmers; ++packed_kmer)
+            all_reverse_kmers[packed_kmer] = packed_kmer;
+        return all_reverse_kmers;
+    }
+    return get_prg_reverse_kmers(parameters, prg_info);
+}
+
+
+std::vector<Pattern> gram::reverse(const Patterns &reverse_kmers) {
     std::vector<Pattern> kmers;
+    kmers.reserve(reverse_kmers.size());
     for (auto reverse_kmer: reverse_kmers) {
         std::reverse(reverse_kmer.begin(), reverse_kmer.end());
         auto &kmer = reverse_kmer;
@@ -886,49 +993,19 @@ std::vector<Pattern> gram::reverse(const ordered_vector_set<Pattern> &reverse_km
 }
 
 
-/**
- * Given the current pattern, find the next one.
- * The rightmost incrementable (value < 4) position is the one incremented, maximising prefix conservation.
- */
-void next_kmer(Pattern &current_kmer, const uint64_t &kmer_size) {
-    int64_t max_update_index = kmer_size - 1;
-
-    // TODO: memory leakage here. Replace with: while (max_update_index >= 0 and current_kmer[max_update_index] == 4)
-    while (current_kmer[max_update_index] == 4)
-        max_update_index--;
-
-    if (max_update_index < 0) { // We have reached '4 4 4 4' and so we are done
-        current_kmer = {};
-        return;
-    }
-    // Increment the focal position
-    current_kmer[max_update_index] = current_kmer[max_update_index] + (uint8_t) 1;
-    // Reset to 1 all positions to the right of the incremented position
-    for (uint64_t i = (uint64_t) max_update_index + 1; i < kmer_size; i++)
-        current_kmer[i] = 1;
-}
-
-ordered_vector_set<Pattern> gram::generate_all_kmers(const uint64_t &kmer_size) {
-    ordered_vector_set<Pattern> all_kmers = {};
-    Pattern current_kmer(kmer_size, 1); // Start with the pattern '1 1 1 1'
-
-    while (true) {
-        all_kmers.insert(current_kmer);
-        next_kmer(current_kmer, kmer_size);
-        if (current_kmer.empty())
-            break;
-    }
+std::vector<Pattern> gram::generate_all_kmers(const uint64_t &kmer_size) {
+    // Packed kmers enumerate all kmers in dictionary order; no ordered set is needed.
+    const uint64_t count_kmers = (uint64_t) 1 << (2 * kmer_size);
+    std::vector<Pattern> all_kmers;
+    all_kmers.reserve(count_kmers);
+    for (PackedKmer packed_kmer = 0; packed_kmer < count_kmers; ++packed_kmer)
+        all_kmers.emplace_back(unpack_kmer(packed_kmer, kmer_size));
     return all_kmers;
 }
 
 std::vector<Pattern> gram::get_all_kmers(const Parameters &parameters,
                                          const PRG_Info &prg_info) {
-    ordered_vector_set<Pattern> ordered_reverse_kmers = {};
-    if (parameters.all_kmers_flag) {
-        ordered_reverse_kmers = generate_all_kmers(parameters.kmers_size);
-    } else {
-        ordered_reverse_kmers = get_prg_reverse_kmers(parameters, prg_info);
-    }
+    auto ordered_reverse_kmers = unpack_kmers(get_all_reverse_kmers(parameters, prg_info), parameters.kmers_size);
     // Call to reverse: changes for eg '1234' to '4321'. c[j]=c[kmers_size-i-1], i the original position, j the new.
     // Then the kmers are stored as seen in the prg, but in ordered fashion such that they have maximally identical suffixes.
     auto ordered_kmers = reverse(ordered_reverse_kmers);
@@ -1,6 +1,6 @@
 #include <algorithm>
-#include <thread>
-#include <unordered_map>
+#include <cstring>
+#include <fstream>
 
 #include "kmer_index/kmers.hpp"
 #include "kmer_index/build.hpp"
@@ -41,31 +41,62 @@ IndexedKmerStats gram::deserialize_next_stats(const uint64_t &stats_index,
 
 
 /**
- * Creates empty `gram::SearchState`s.
- * These will get populated with `gram::SA_interval`s and `gram::variant_site_path`s.
+ * Lays out the CSR skeleton of a `gram::KmerIndex` from the serialised kmers and kmer statistics:
+ * the sorted kmers, their search state offsets and the path offsets of each `gram::SearchState`.
+ * `gram::SA_Interval`s and `gram::VariantSitePath`s are left empty, to be populated from their own files.
+ * Does nothing if the index has already been laid out.
  */
-void pad_search_states(SearchStates &search_states,
-                       const IndexedKmerStats &stats) {
-    // The function may not do anything if called on already existing `SearchStates`.
-    // This occurs when expected_count evaluates to 0.
-    auto expected_count = stats.count_search_states - search_states.size();
-    for (uint64_t i = search_states.size(); i < expected_count; ++i)
-        search_states.emplace_back(SearchState{});
+void initialise_kmer_index(KmerIndex &kmer_index,
+                           const sdsl::int_vector<3> &all_kmers,
+                           const sdsl::int_vector<> &kmers_stats,
+                           const uint32_t &kmers_size) {
+    if (not kmer_index.empty())
+        return;
+
+    // Pairs each serialised kmer with the start of its statistics.
+    std::vector<std::pair<PackedKmer, uint64_t>> serialised_kmers;
+    serialised_kmers.reserve(all_kmers.size() / kmers_size);
+    uint64_t stats_index = 0;
+    uint64_t kmer_start_index = 0;
+    while (kmer_start_index + kmers_size <= all_kmers.size()) {
+        auto kmer = deserialize_next_kmer(kmer_start_index, all_kmers, kmers_size);
+        kmer_start_index += kmers_size;
+        serialised_kmers.emplace_back(pack_kmer(kmer), stats_index);
+        stats_index += kmers_stats[stats_index] + 1;
+    }
+    std::sort(serialised_kmers.begin(), serialised_kmers.end());
+
+    kmer_index.kmer_size = kmers_size;
+    kmer_index.kmers.reserve(serialised_kmers.size());
+    for (const auto &serialised_kmer: serialised_kmers) {
+        auto stats = deserialize_next_stats(serialised_kmer.second, kmers_stats);
+        kmer_index.kmers.push_back(serialised_kmer.first);
+        for (const auto &path_length: stats.path_lengths) {
+            kmer_index.sa_intervals.emplace_back(SA_Interval{});
+            kmer_index.variant_site_states.push_back(SearchVariantSiteState::unknown);
+            kmer_index.paths_offsets.push_back(kmer_index.paths_offsets.back() + path_length);
+        }
+        kmer_index.search_states_offsets.push_back(kmer_index.sa_intervals.size());
+    }
+    kmer_index.paths.resize(kmer_index.paths_offsets.back());
 }
 
 
 /**
- * Populates each `gram::SearchState` of an indexed kmer with its start and end SA indices.
- * @param sa_intervals all the `gram::SA_Interval`s deserialised.
+ * Finds the position in the `gram::KmerIndex` of each serialised kmer, in serialisation order.
  */
-void handle_sa_interval(SearchStates &search_states,
-                        uint64_t &sa_interval_index,
-                        const sdsl::int_vector<> &sa_intervals) {
-    for (auto &search_state: search_states) {
-        search_state.sa_interval.first = sa_intervals[sa_interval_index];
-        search_state.sa_interval.second = sa_intervals[sa_interval_index + 1];
-        sa_interval_index += 2;
+std::vector<uint64_t> get_kmer_positions(const KmerIndex &kmer_index,
+                                         const sdsl::int_vector<3> &all_kmers,
+                                         const uint32_t &kmers_size) {
+    std::vector<uint64_t> kmer_positions;
+    kmer_positions.reserve(all_kmers.size() / kmers_size);
+    uint64_t kmer_start_index = 0;
+    while (kmer_start_index + kmers_size <= all_kmers.size()) {
+        auto kmer = deserialize_next_kmer(kmer_start_index, all_kmers, kmers_size);
+        kmer_start_index += kmers_size;
+        kmer_positions.push_back(kmer_index.find(kmer));
     }
+    return kmer_positions;
 }
 
 
@@ -77,48 +108,18 @@ void gram::parse_sa_intervals(KmerIndex &kmer_index,
     sdsl::int_vector<> sa_intervals;
     load_from_file(sa_intervals, parameters.sa_intervals_fpath);
 
-    uint64_t stats_index = 0;
-    uint64_t kmer_start_index = 0;
-
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index, all_kmers, parameters.kmers_size);
-        kmer_start_index += parameters.kmers_size;
-
-        auto stats = deserialize_next_stats(stats_index, kmers_stats);
-        stats_index += stats.count_search_states + 1;
-
-        // Creates an empty `SearchStates` for the next indexed kmer, adds it to the `KmerIndex`, returns it. (unordered_map STL behaviour).
-        auto &search_states = kmer_index[kmer];
-        pad_search_states(search_states, stats);
-
-        handle_sa_interval(search_states,
-                           sa_interval_index,
-                           sa_intervals);
-    }
-}
-
-
-/**
- * Populate each `gram::SearchState` of an indexed kmer with its `gram::variant_site_path`.
- * @param paths the serialised `gram::variant_site_path`s.
- */
-void handle_path_element(SearchStates &search_states,
-                         uint64_t &paths_index,
-                         const sdsl::int_vector<> &paths,
-                         const IndexedKmerStats &stats) {
-    uint64_t i = 0;
-    for (auto &search_state: search_states) {
-        // The path_length of each `SearchState` has been extracted from the serialised kmer stats.
-        // Note that it can be 0, in which case the variant_site_path remains empty.
-        const auto &path_length = stats.path_lengths[i++];
-
-        for (uint64_t j = 0; j < path_length; ++j) {
-            Marker marker = paths[paths_index];
-            AlleleId allele_id = paths[paths_index + 1];
-            paths_index += 2;
-
-            VariantLocus site = {marker, allele_id};
-            search_state.variant_site_path.emplace_back(site);
+    initialise_kmer_index(kmer_index, all_kmers, kmers_stats, parameters.kmers_size);
+    const auto kmer_positions = get_kmer_positions(kmer_index, all_kmers, parameters.kmers_size);
+
+    // The serialised SA intervals follow the serialised kmers order.
+    auto &kmers_sa_intervals = kmer_index.sa_intervals.own();
+    for (const auto &kmer_position: kmer_positions) {
+        const auto &first = kmer_index.search_states_offsets[kmer_position];
+        const auto &last = kmer_index.search_states_offsets[kmer_position + 1];
+        for (uint64_t i = first; i < last; ++i) {
+            kmers_sa_intervals[i].first = sa_intervals[sa_interval_index];
+            kmers_sa_intervals[i].second = sa_intervals[sa_interval_index + 1];
+            sa_interval_index += 2;
         }
     }
 }
@@ -132,31 +133,86 @@ void gram::parse_paths(KmerIndex &kmer_index,
     sdsl::int_vector<> paths;
     load_from_file(paths, parameters.paths_fpath);
 
-    uint64_t stats_index = 0;
-    uint64_t kmer_start_index = 0;
+    initialise_kmer_index(kmer_index, all_kmers, kmers_stats, parameters.kmers_size);
+    const auto kmer_positions = get_kmer_positions(kmer_index, all_kmers, parameters.kmers_size);
+
+    // The serialised paths follow the serialised kmers order; path lengths were laid out from the kmer stats.
+    auto &kmers_paths = kmer_index.paths.own();
+    for (const auto &kmer_position: kmer_positions) {
+        const auto &first_search_state = kmer_index.search_states_offsets[kmer_position];
+        const auto &last_search_state = kmer_index.search_states_offsets[kmer_position + 1];
+        const auto &first = kmer_index.paths_offsets[first_search_state];
+        const auto &last = kmer_index.paths_offsets[last_search_state];
+        for (uint64_t i = first; i < last; ++i) {
+            Marker marker = paths[paths_index];
+            AlleleId allele_id = paths[paths_index + 1];
+            paths_index += 2;
+            kmers_paths[i] = VariantLocus{marker, allele_id};
+        }
+    }
+}
+
 
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index,
-                                          all_kmers,
-                                          parameters.kmers_size);
-        kmer_start_index += parameters.kmers_size;
+/**
+ * Views the next array of the mapped kmer index file, and moves `offset` past its padding.
+ */
+template<typename T>
+MappedVector<T> view_kmer_index_array(const MemoryMapPtr &memory_map, uint64_t &offset, const uint64_t &count) {
+    // `count` comes from the file: bound it by the bytes left before computing its byte size, which could wrap.
+    const auto map_size = memory_map->size();
+    bool fits = offset <= map_size and count <= (map_size - offset) / sizeof(T);
+    const uint64_t size = fits ? count * sizeof(T) : 0;
+    const uint64_t padding = (kmer_index_file_alignment - size % kmer_index_file_alignment) % kmer_index_file_alignment;
+    fits = fits and padding <= map_size - offset - size;
+    if (not fits) {
+        std::cout << "Kmer index file is truncated" << std::endl;
+        exit(1);
+    }
+    const auto elements = (const T *) (memory_map->data() + offset);
+    offset += size + padding;
+    return MappedVector<T>::view(elements, count, memory_map);
+}
 
-        auto stats = deserialize_next_stats(stats_index, kmers_stats);
-        stats_index += stats.count_search_states + 1;
 
-        // This brings back existing `SearchStates`, created in function parse_sa_intervals.
-        auto &search_states = kmer_index[kmer];
-        pad_search_states(search_states, stats);
+KmerIndex gram::load_kmer_index_file(const Parameters &parameters) {
+    auto memory_map = map_file(parameters.kmer_index_fpath);
 
-        handle_path_element(search_states,
-                            paths_index,
-                            paths,
-                            stats);
+    KmerIndexFileHeader header = {};
+    if (memory_map->size() < sizeof(header)) {
+        std::cout << "Kmer index file is truncated" << std::endl;
+        exit(1);
+    }
+    std::memcpy(&header, memory_map->data(), sizeof(header));
+    if (std::memcmp(header.magic, kmer_index_file_magic, sizeof(header.magic)) != 0
+        or header.byte_order != kmer_index_file_byte_order) {
+        std::cout << "Not a kmer index file for this machine: " << parameters.kmer_index_fpath << std::endl;
+        exit(1);
     }
+    if (header.version != kmer_index_file_version) {
+        std::cout << "Kmer index file version " << header.version
+                  << " is not supported (expected version " << kmer_index_file_version << ")."
+                  << " Please re-run gramtools build." << std::endl;
+        exit(1);
+    }
+
+    KmerIndex kmer_index;
+    kmer_index.kmer_size = header.kmer_size;
+    uint64_t offset = sizeof(header);
+    kmer_index.kmers = view_kmer_index_array<PackedKmer>(memory_map, offset, header.count_kmers);
+    kmer_index.search_states_offsets = view_kmer_index_array<uint64_t>(memory_map, offset, header.count_kmers + 1);
+    kmer_index.paths_offsets = view_kmer_index_array<uint64_t>(memory_map, offset, header.count_search_states + 1);
+    kmer_index.sa_intervals = view_kmer_index_array<SA_Interval>(memory_map, offset, header.count_search_states);
+    kmer_index.paths = view_kmer_index_array<VariantLocus>(memory_map, offset, header.count_path_elements);
+    kmer_index.variant_site_states = view_kmer_index_array<SearchVariantSiteState>(memory_map, offset,
+                                                                                   header.count_search_states);
+    return kmer_index;
 }
 
 
 KmerIndex gram::kmer_index::load(const Parameters &parameters) {
+    if (std::ifstream(parameters.kmer_index_fpath).good())
+        return load_kmer_index_file(parameters);
+
     KmerIndex kmer_index;
 
     sdsl::int_vector<3> all_kmers;
@@ -17,6 +17,7 @@
 
 #include "quasimap/quasimap.hpp"
 #include "quasimap/parameters.hpp"
+#include "quasimap/coverage/binary.hpp"
 
 #include "main.hpp"
 
@@ -41,6 +42,9 @@ int main(int argc, const char *const *argv) {
         case Commands::quasimap:
             commands::quasimap::run(parameters);
             break;
+        case Commands::coverage_to_json:
+            commands::coverage_to_json::run(parameters);
+            break;
     }
     return 0;
 }
@@ -75,6 +79,9 @@ std::pair<Parameters, Commands> gram::parse_command_line_parameters(int argc, co
     } else if (cmd == "quasimap") {
         auto parameters = commands::quasimap::parse_parameters(vm, parsed);
         return std::make_pair(parameters, Commands::quasimap);
+    } else if (cmd == "coverage_to_json") {
+        auto parameters = commands::coverage_to_json::parse_parameters(vm, parsed);
+        return std::make_pair(parameters, Commands::coverage_to_json);
     }
 
     // unrecognised command
@@ -1,3 +1,7 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
 #include <boost/filesystem.hpp>
 
 #include "common/utils.hpp"
@@ -7,72 +11,129 @@
 namespace fs = boost::filesystem;
 using namespace gram;
 
-/**
- * Generates a bit vector with bit set if the given DNA `base` is present at each index of the BWT.
- */
-sdsl::bit_vector generate_base_bwt_mask(const Base &base,
-                                        const FM_Index &fm_index) {
-    sdsl::bit_vector mask(fm_index.bwt.size(), 0);
-    for (uint64_t i = 0; i < fm_index.bwt.size(); i++)
-        mask[i] = fm_index.bwt[i] == base;
-    return mask;
+
+DNA_BWT_Occ::DNA_BWT_Occ(const FM_Index &fm_index) {
+    bwt_size = fm_index.bwt.size();
+    // One extra block so that a rank query at `bwt_size` is valid.
+    auto &owned_blocks = blocks.own();
+    owned_blocks.resize(bwt_size / block_size + 1);
+
+    uint64_t counts[4] = {0, 0, 0, 0};
+    for (uint64_t block_index = 0; block_index < owned_blocks.size(); ++block_index) {
+        auto &block = owned_blocks[block_index];
+        for (uint64_t i = 0; i < 4; ++i) {
+            block.counts[i] = counts[i];
+            block.bits[i] = 0;
+        }
+
+        auto block_start = block_index * block_size;
+        auto block_end = std::min(block_start + block_size, bwt_size);
+        for (uint64_t i = block_start; i < block_end; ++i) {
+            uint64_t bwt_char = fm_index.bwt[i];
+            bool is_dna = bwt_char >= 1 and bwt_char <= 4;
+            if (not is_dna)
+                continue;
+            block.bits[bwt_char - 1] |= uint64_t(1) << (i - block_start);
+            ++counts[bwt_char - 1];
+        }
+    }
+}
+
+DNA_BWT_Occ DNA_BWT_Occ::view(const uint64_t &bwt_size,
+                              const DNA_BWT_OccBlock *blocks,
+                              const uint64_t &number_of_blocks,
+                              MemoryMapPtr memory_map) {
+    DNA_BWT_Occ dna_bwt_occ;
+    dna_bwt_occ.bwt_size = bwt_size;
+    dna_bwt_occ.blocks = MappedVector<DNA_BWT_OccBlock>::view(blocks, number_of_blocks, std::move(memory_map));
+    return dna_bwt_occ;
+}
+
+void DNA_BWT_Occ::serialize(std::ostream &out) const {
+    uint64_t number_of_blocks = blocks.size();
+    out.write((const char *) &bwt_size, sizeof(bwt_size));
+    out.write((const char *) &number_of_blocks, sizeof(number_of_blocks));
+    out.write((const char *) blocks.data(), number_of_blocks * sizeof(DNA_BWT_OccBlock));
+}
+
+void DNA_BWT_Occ::load(std::istream &in) {
+    uint64_t number_of_blocks = 0;
+    in.read((char *) &bwt_size, sizeof(bwt_size));
+    in.read((char *) &number_of_blocks, sizeof(number_of_blocks));
+    if (not in or number_of_blocks != bwt_size / block_size + 1) {
+        in.setstate(std::ios::failbit);
+        return;
+    }
+    std::vector<DNA_BWT_OccBlock> loaded_blocks(number_of_blocks);
+    in.read((char *) loaded_blocks.data(), number_of_blocks * sizeof(DNA_BWT_OccBlock));
+    blocks = MappedVector<DNA_BWT_OccBlock>(std::move(loaded_blocks));
 }
 
+bool DNA_BWT_Occ::operator==(const DNA_BWT_Occ &other) const {
+    if (bwt_size != other.bwt_size or blocks.size() != other.blocks.size())
+        return false;
+    for (uint64_t i = 0; i < blocks.size(); ++i) {
+        for (uint64_t j = 0; j < 4; ++j) {
+            if (blocks[i].counts[j] != other.blocks[i].counts[j]
+                or blocks[i].bits[j] != other.blocks[i].bits[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+
 /**
- * Generates a filename for a BWT mask for nucleotide bases.
- * @see generate_base_bwt_mask()
+ * Generates the filename of the DNA occurrence table.
  */
-std::string bwt_mask_fname(const std::string &base_char,
-                           const Parameters &parameters) {
+std::string dna_bwt_occ_fname(const Parameters &parameters) {
     auto handling_unit_tests = parameters.gram_dirpath[0] == '@';
-    if (handling_unit_tests) {
-        return parameters.gram_dirpath
-               + "_"
-               + base_char
-               + "_base_bwt_mask";
-    }
+    if (handling_unit_tests)
+        return parameters.gram_dirpath + "_dna_bwt_occ";
     fs::path dir(parameters.gram_dirpath);
-    fs::path file(base_char + "_base_bwt_mask");
+    fs::path file("dna_bwt_occ");
     fs::path full_path = dir / file;
     return full_path.string();
 }
 
-void gram::generate_dna_bwt_masks(const FM_Index &fm_index,
-                                  const Parameters &parameters) {
-    auto a_mask = generate_base_bwt_mask(1, fm_index);
-    auto c_mask = generate_base_bwt_mask(2, fm_index);
-    auto g_mask = generate_base_bwt_mask(3, fm_index);
-    auto t_mask = generate_base_bwt_mask(4, fm_index);
-
-    auto fpath = bwt_mask_fname("a", parameters);
-    sdsl::store_to_file(a_mask, fpath);
-
-    fpath = bwt_mask_fname("c", parameters);
-    sdsl::store_to_file(c_mask, fpath);
-
-    fpath = bwt_mask_fname("g", parameters);
-    sdsl::store_to_file(g_mask, fpath);
-
-    fpath = bwt_mask_fname("t", parameters);
-    sdsl::store_to_file(t_mask, fpath);
+DNA_BWT_Occ gram::generate_dna_bwt_occ(const FM_Index &fm_index,
+                                       const Parameters &parameters) {
+    DNA_BWT_Occ dna_bwt_occ(fm_index);
+    std::ofstream out(dna_bwt_occ_fname(parameters), std::ios::binary);
+    out.write(dna_bwt_occ_file_magic, sizeof(dna_bwt_occ_file_magic));
+    out.write((const char *) &dna_bwt_occ_file_version, sizeof(dna_bwt_occ_file_version));
+    dna_bwt_occ.serialize(out);
+    return dna_bwt_occ;
 }
 
+DNA_BWT_Occ gram::load_dna_bwt_occ(const Parameters &parameters) {
+    const auto fpath = dna_bwt_occ_fname(parameters);
+    std::ifstream in(fpath, std::ios::binary);
+    if (not in.is_open()) {
+        std::cout << "Problem reading DNA occurrence table file: " << fpath << std::endl;
+        exit(1);
+    }
 
-sdsl::bit_vector load_base_bwt_mask(const std::string &base_char,
-                                    const Parameters &parameters) {
-    auto fpath = bwt_mask_fname(base_char, parameters);
-    sdsl::bit_vector mask;
-    sdsl::load_from_file(mask, fpath);
-    return mask;
-}
-
+    char magic[sizeof(dna_bwt_occ_file_magic)] = {};
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    in.read((char *) &version, sizeof(version));
+    if (not in or std::memcmp(magic, dna_bwt_occ_file_magic, sizeof(magic)) != 0) {
+        std::cout << "Not a DNA occurrence table file: " << fpath << std::endl;
+        exit(1);
+    }
+    if (version != dna_bwt_occ_file_version) {
+        std::cout << "DNA occurrence table file version " << version
+                  << " is not supported (expected version " << dna_bwt_occ_file_version << ")."
+                  << " Please re-run gramtools build." << std::endl;
+        exit(1);
+    }
 
-DNA_BWT_Masks gram::load_dna_bwt_masks(const FM_Index &fm_index,
-                                       const Parameters &parameters) {
-    DNA_BWT_Masks dna_bwt_masks = {};
-    dna_bwt_masks.mask_a = load_base_bwt_mask("a", parameters);
-    dna_bwt_masks.mask_c = load_base_bwt_mask("c", parameters);
-    dna_bwt_masks.mask_g = load_base_bwt_mask("g", parameters);
-    dna_bwt_masks.mask_t = load_base_bwt_mask("t", parameters);
-    return dna_bwt_masks;
+    DNA_BWT_Occ dna_bwt_occ;
+    dna_bwt_occ.load(in);
+    if (not in) {
+        std::cout << "DNA occurrence table file is truncated or corrupt: " << fpath << std::endl;
+        exit(1);
+    }
+    return dna_bwt_occ;
 }
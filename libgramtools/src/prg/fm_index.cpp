@@ -28,3 +28,65 @@ FM_Index gram::generate_fm_index(const Parameters &parameters) {
     sdsl::store_to_file(fm_index, parameters.fm_index_fpath);
     return fm_index;
 }
+
+/**
+ * Number of variant markers in the BWT, which is also the number of suffixes starting with a marker.
+ * Markers are the largest symbols of the prg, so their suffixes sort last.
+ */
+uint64_t count_bwt_markers(const FM_Index &fm_index) {
+    for (uint64_t alphabet_rank = 0; alphabet_rank < fm_index.sigma; ++alphabet_rank) {
+        if (fm_index.comp2char[alphabet_rank] > 4)
+            return fm_index.size() - fm_index.C[alphabet_rank];
+    }
+    return 0;
+}
+
+SuffixArraySamples gram::generate_suffix_array_samples(const FM_Index &fm_index, const uint64_t &sampling_interval) {
+    const uint64_t sa_size = fm_index.size();
+    const bool all_sampled = sampling_interval <= 1;
+    // The suffix array is a permutation of the prg positions: one in `sampling_interval` of them is sampled.
+    const uint64_t count_samples = all_sampled ? sa_size : (sa_size + sampling_interval - 1) / sampling_interval;
+    const uint64_t count_markers = all_sampled ? 0 : count_bwt_markers(fm_index);
+    const uint64_t first_marker_sa_index = sa_size - count_markers;
+
+    SuffixArraySamples samples = {};
+    samples.suffix_array = sdsl::int_vector<>(count_samples, 0, 64);
+    samples.bwt_markers_sa = sdsl::int_vector<>(count_markers, 0, 64);
+    samples.markers_sa = sdsl::int_vector<>(count_markers, 0, 64);
+    if (not all_sampled)
+        samples.sa_samples_mask = sdsl::bit_vector(sa_size, 0);
+
+    uint64_t sample_index = 0;
+    uint64_t marker_rank = 0;
+    for (uint64_t i = 0; i < sa_size; ++i) {
+        const uint64_t sa_value = fm_index[i];
+        if (all_sampled) {
+            samples.suffix_array[i] = sa_value;
+            continue;
+        }
+
+        if (sa_value % sampling_interval == 0) {
+            samples.suffix_array[sample_index++] = sa_value;
+            samples.sa_samples_mask[i] = 1;
+        }
+        if (fm_index.bwt[i] > 4)
+            samples.bwt_markers_sa[marker_rank++] = sa_value;
+        if (i >= first_marker_sa_index)
+            samples.markers_sa[i - first_marker_sa_index] = sa_value;
+    }
+
+    sdsl::util::bit_compress(samples.suffix_array);
+    sdsl::util::bit_compress(samples.bwt_markers_sa);
+    sdsl::util::bit_compress(samples.markers_sa);
+    return samples;
+}
+
+DNA_FirstSA_Indexes gram::generate_dna_first_sa_indexes(const FM_Index &fm_index) {
+    DNA_FirstSA_Indexes dna_first_sa_indexes = {};
+    for (uint64_t dna_base = 1; dna_base <= 4; ++dna_base) {
+        // char2comp -> rank of ordered alphabet set
+        auto alphabet_rank = fm_index.char2comp[dna_base];
+        dna_first_sa_indexes[dna_base] = fm_index.C[alphabet_rank];
+    }
+    return dna_first_sa_indexes;
+}
@@ -23,6 +23,21 @@ sdsl::bit_vector gram::generate_bwt_markers_mask(const FM_Index &fm_index) {
 }
 
 
+sdsl::int_vector<> gram::generate_bwt_markers(const FM_Index &fm_index,
+                                              const sdsl::bit_vector &bwt_markers_mask,
+                                              const uint64_t &count_markers) {
+    // Markers are the largest symbols of the prg: the largest one sets the width.
+    const uint64_t max_alphabet_char = fm_index.comp2char[fm_index.sigma - 1];
+    sdsl::int_vector<> bwt_markers(count_markers, 0, 64 - __builtin_clzll(max_alphabet_char));
+    uint64_t marker_rank = 0;
+    for (uint64_t i = 0; i < bwt_markers_mask.size(); i++) {
+        if (bwt_markers_mask[i])
+            bwt_markers[marker_rank++] = fm_index.bwt[i];
+    }
+    return bwt_markers;
+}
+
+
 sdsl::int_vector<> gram::load_allele_mask(const Parameters &parameters) {
     sdsl::int_vector<> allele_mask;
     sdsl::load_from_file(allele_mask, parameters.allele_mask_fpath);
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cassert>
+
 #include "prg/masks.hpp"
 #include "prg/prg.hpp"
+#include "prg/prg_bundle.hpp"
 
 
 using namespace gram;
@@ -7,17 +11,75 @@ using namespace gram;
 uint64_t gram::dna_bwt_rank(const uint64_t &upper_index,
                             const Marker &dna_base,
                             const PRG_Info &prg_info) {
-    switch (dna_base) {
-        case 1:
-            return prg_info.rank_bwt_a(upper_index);
-        case 2:
-            return prg_info.rank_bwt_c(upper_index);
-        case 3:
-            return prg_info.rank_bwt_g(upper_index);
-        case 4:
-            return prg_info.rank_bwt_t(upper_index);
-        default:
-            return 0;
+    bool is_dna = dna_base >= 1 and dna_base <= 4;
+    if (not is_dna)
+        return 0;
+    return prg_info.dna_bwt_occ.rank(upper_index, (Base) dna_base);
+}
+
+SitesMarkerInfo gram::generate_sites_marker_info(const FM_Index &fm_index) {
+    SitesMarkerInfo sites_marker_info;
+    // sigma: is the size (=number of unique symbols) of the alphabet
+    const uint64_t max_alphabet_char = fm_index.comp2char[fm_index.sigma - 1];
+
+    for (uint64_t site_marker = 5; site_marker <= max_alphabet_char; site_marker += 2) {
+        // Site markers need not be contiguous: an absent one keeps an empty entry so that sites stay indexed by marker.
+        const auto alphabet_rank = fm_index.char2comp[site_marker];
+        if (alphabet_rank == 0) {
+            sites_marker_info.push_back(SiteMarkerInfo{});
+            continue;
+        }
+
+        // Both site markers sort next to each other in the suffix array.
+        const SA_Index first_sa_index = fm_index.C[alphabet_rank];
+        const SA_Index second_sa_index = first_sa_index + 1;
+        const uint64_t first_prg_index = fm_index[first_sa_index];
+        const uint64_t second_prg_index = fm_index[second_sa_index];
+        const bool start_is_first_sa = first_prg_index < second_prg_index;
+
+        SiteMarkerInfo site_info = {};
+        site_info.start_sa_index = start_is_first_sa ? first_sa_index : second_sa_index;
+        site_info.end_sa_index = start_is_first_sa ? second_sa_index : first_sa_index;
+        site_info.start_prg_index = std::min(first_prg_index, second_prg_index);
+        site_info.end_prg_index = std::max(first_prg_index, second_prg_index);
+
+        // LF mapping preserves the BWT order of the two marker occurrences: the first maps to `first_sa_index`.
+        site_info.sa_right_of_start = fm_index.bwt.select(start_is_first_sa ? 1 : 2, site_marker);
+
+        // The allele marker's suffixes end where those of the next symbol in the alphabet start.
+        const auto allele_marker_rank = fm_index.char2comp[site_marker + 1];
+        site_info.allele_marker_first_sa_index = fm_index.C[allele_marker_rank];
+        site_info.allele_marker_last_sa_index = fm_index.C[allele_marker_rank + 1] - 1;
+        // The variant site exit point also marks the last allele's end point.
+        site_info.count_alleles = site_info.allele_marker_last_sa_index
+                                  - site_info.allele_marker_first_sa_index + 2;
+
+        sites_marker_info.push_back(site_info);
+    }
+    return sites_marker_info;
+}
+
+uint64_t gram::locate(const uint64_t &sa_index, const PRG_Info &prg_info) {
+    if (prg_info.sa_sampling_interval <= 1)
+        return prg_info.suffix_array[sa_index];
+
+    const uint64_t first_marker_sa_index = prg_info.dna_bwt_occ.size() - prg_info.markers_sa.size();
+    uint64_t current_sa_index = sa_index;
+    uint64_t count_steps = 0;
+    while (true) {
+        if (current_sa_index >= first_marker_sa_index)
+            return prg_info.markers_sa[current_sa_index - first_marker_sa_index] + count_steps;
+        if (prg_info.bwt_markers_mask[current_sa_index])
+            return prg_info.bwt_markers_sa[prg_info.bwt_markers_rank(current_sa_index)] + count_steps;
+        if (prg_info.sa_samples_mask[current_sa_index])
+            return prg_info.suffix_array[prg_info.sa_samples_rank(current_sa_index)] + count_steps;
+
+        // Step to the suffix starting one prg position to the left. The prg start is sampled, so a DNA base precedes.
+        const auto dna_base = prg_info.dna_bwt_occ.dna_base(current_sa_index);
+        assert(dna_base != 0);
+        current_sa_index = prg_info.dna_first_sa_indexes[dna_base]
+                           + prg_info.dna_bwt_occ.rank(current_sa_index, dna_base);
+        ++count_steps;
     }
 }
 
@@ -147,12 +209,22 @@ EncodeResult gram::encode_char(const char &c) {
 }
 
 PRG_Info gram::load_prg_info(const Parameters &parameters) {
+    if (std::ifstream(parameters.prg_info_bundle_fpath).good())
+        return load_prg_info_bundle(parameters);
+
     PRG_Info prg_info = {};
 
     prg_info.encoded_prg = parse_raw_prg_file(parameters.linear_prg_fpath);
     prg_info.max_alphabet_num = get_max_alphabet_num(prg_info.encoded_prg);
 
     prg_info.fm_index = load_fm_index(parameters);
+    auto sa_samples = generate_suffix_array_samples(prg_info.fm_index, prg_info.sa_sampling_interval);
+    prg_info.suffix_array = std::move(sa_samples.suffix_array);
+    prg_info.sa_samples_mask = std::move(sa_samples.sa_samples_mask);
+    prg_info.sa_samples_rank = sdsl::rank_support_v<1>(&prg_info.sa_samples_mask);
+    prg_info.bwt_markers_sa = std::move(sa_samples.bwt_markers_sa);
+    prg_info.markers_sa = std::move(sa_samples.markers_sa);
+    prg_info.dna_first_sa_indexes = generate_dna_first_sa_indexes(prg_info.fm_index);
     prg_info.sites_mask = load_sites_mask(parameters);
     prg_info.allele_mask = load_allele_mask(parameters);
 
@@ -164,12 +236,16 @@ PRG_Info gram::load_prg_info(const Parameters &parameters) {
             prg_info.prg_markers_rank(prg_info.prg_markers_mask.size());
 
     prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers = generate_bwt_markers(prg_info.fm_index,
+                                                prg_info.bwt_markers_mask,
+                                                prg_info.markers_mask_count_set_bits);
 
-    prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index, parameters);
-    prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-    prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-    prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-    prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+    prg_info.dna_bwt_occ = load_dna_bwt_occ(parameters);
+    prg_info.sites_marker_info = generate_sites_marker_info(prg_info.fm_index);
 
+    // Everything quasimap needs is now derived: release the wavelet tree.
+    prg_info.fm_index = FM_Index();
     return prg_info;
 }
\ No newline at end of file
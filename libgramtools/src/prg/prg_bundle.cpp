@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#include "common/memory_map.hpp"
+#include "prg/prg_bundle.hpp"
+
+
+using namespace gram;
+
+
+namespace {
+    constexpr uint64_t page_size = 4096;
+    constexpr uint64_t byte_order = 0x0102030405060708;
+    constexpr char magic[8] = {'G', 'R', 'A', 'M', 'P', 'R', 'G', 'B'};
+
+    enum Section {
+        suffix_array_section,
+        sa_samples_mask_section,
+        sa_samples_rank_section,
+        bwt_markers_sa_section,
+        markers_sa_section,
+        encoded_prg_section,
+        sites_mask_section,
+        allele_mask_section,
+        bwt_markers_mask_section,
+        bwt_markers_rank_section,
+        bwt_markers_select_section,
+        bwt_markers_section,
+        prg_markers_mask_section,
+        prg_markers_rank_section,
+        prg_markers_select_section,
+        dna_bwt_occ_section,
+        sites_marker_info_section,
+        count_sections
+    };
+
+    struct SectionExtent {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /**
+     * Occupies the first page of the bundle.
+     */
+    struct BundleHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t page_size;
+        uint64_t byte_order;
+        uint64_t max_alphabet_num;
+        uint64_t markers_mask_count_set_bits;
+        uint64_t dna_bwt_size;
+        uint64_t dna_first_sa_indexes[5];
+        uint64_t sa_sampling_interval;
+        SectionExtent sections[count_sections];
+    };
+    static_assert(sizeof(BundleHeader) <= page_size, "the bundle header fits in its page");
+    static_assert(std::is_trivially_copyable<SiteMarkerInfo>::value, "the sites marker info is stored as raw bytes");
+}
+
+
+/**
+ * Pads the output up to the next page boundary, then writes a section with `write_section` and records its extent.
+ */
+template<typename WriteSection>
+void write_section(std::ofstream &out, SectionExtent &extent, WriteSection write_section) {
+    const uint64_t position = out.tellp();
+    const uint64_t padding = (page_size - position % page_size) % page_size;
+    for (uint64_t i = 0; i < padding; ++i)
+        out.put(0);
+    extent.offset = position + padding;
+    write_section(out);
+    extent.size = (uint64_t) out.tellp() - extent.offset;
+}
+
+
+void gram::dump_prg_info_bundle(const PRG_Info &prg_info, const Parameters &parameters) {
+    BundleHeader header = {};
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = prg_info_bundle_version;
+    header.page_size = page_size;
+    header.byte_order = byte_order;
+    header.max_alphabet_num = prg_info.max_alphabet_num;
+    header.markers_mask_count_set_bits = prg_info.markers_mask_count_set_bits;
+    header.dna_bwt_size = prg_info.dna_bwt_occ.size();
+    header.sa_sampling_interval = prg_info.sa_sampling_interval;
+    std::copy(prg_info.dna_first_sa_indexes.begin(), prg_info.dna_first_sa_indexes.end(), header.dna_first_sa_indexes);
+
+    std::ofstream out(parameters.prg_info_bundle_fpath, std::ios::binary);
+    // The header is only known once all sections are written; reserve its page.
+    out.write((const char *) &header, sizeof(header));
+
+    auto &sections = header.sections;
+    write_section(out, sections[suffix_array_section], [&](std::ofstream &o) { prg_info.suffix_array.serialize(o); });
+    write_section(out, sections[sa_samples_mask_section],
+                  [&](std::ofstream &o) { prg_info.sa_samples_mask.serialize(o); });
+    write_section(out, sections[sa_samples_rank_section],
+                  [&](std::ofstream &o) { prg_info.sa_samples_rank.serialize(o); });
+    write_section(out, sections[bwt_markers_sa_section], [&](std::ofstream &o) { prg_info.bwt_markers_sa.serialize(o); });
+    write_section(out, sections[markers_sa_section], [&](std::ofstream &o) { prg_info.markers_sa.serialize(o); });
+    write_section(out, sections[encoded_prg_section], [&](std::ofstream &o) { prg_info.encoded_prg.serialize(o); });
+    write_section(out, sections[sites_mask_section], [&](std::ofstream &o) { prg_info.sites_mask.serialize(o); });
+    write_section(out, sections[allele_mask_section], [&](std::ofstream &o) { prg_info.allele_mask.serialize(o); });
+    write_section(out, sections[bwt_markers_mask_section],
+                  [&](std::ofstream &o) { prg_info.bwt_markers_mask.serialize(o); });
+    write_section(out, sections[bwt_markers_rank_section],
+                  [&](std::ofstream &o) { prg_info.bwt_markers_rank.serialize(o); });
+    write_section(out, sections[bwt_markers_select_section],
+                  [&](std::ofstream &o) { prg_info.bwt_markers_select.serialize(o); });
+    write_section(out, sections[bwt_markers_section], [&](std::ofstream &o) { prg_info.bwt_markers.serialize(o); });
+    write_section(out, sections[prg_markers_mask_section],
+                  [&](std::ofstream &o) { prg_info.prg_markers_mask.serialize(o); });
+    write_section(out, sections[prg_markers_rank_section],
+                  [&](std::ofstream &o) { prg_info.prg_markers_rank.serialize(o); });
+    write_section(out, sections[prg_markers_select_section],
+                  [&](std::ofstream &o) { prg_info.prg_markers_select.serialize(o); });
+    write_section(out, sections[dna_bwt_occ_section], [&](std::ofstream &o) {
+        o.write((const char *) prg_info.dna_bwt_occ.data(),
+                prg_info.dna_bwt_occ.number_of_blocks() * sizeof(DNA_BWT_OccBlock));
+    });
+    write_section(out, sections[sites_marker_info_section], [&](std::ofstream &o) {
+        o.write((const char *) prg_info.sites_marker_info.data(),
+                prg_info.sites_marker_info.size() * sizeof(SiteMarkerInfo));
+    });
+
+    out.seekp(0);
+    out.write((const char *) &header, sizeof(header));
+}
+
+
+/**
+ * Deserialises a stream-loadable component from its section of the mapped bundle.
+ */
+template<typename Load>
+void load_section(const MemoryMapPtr &memory_map, const SectionExtent &extent, Load load) {
+    MemoryStreamBuffer buffer(memory_map->data() + extent.offset, extent.size);
+    std::istream in(&buffer);
+    load(in);
+}
+
+
+PRG_Info gram::load_prg_info_bundle(const Parameters &parameters) {
+    auto memory_map = map_file(parameters.prg_info_bundle_fpath);
+
+    BundleHeader header = {};
+    bool truncated = memory_map->size() < sizeof(header);
+    if (not truncated)
+        std::memcpy(&header, memory_map->data(), sizeof(header));
+    for (const auto &extent: header.sections)
+        truncated = truncated
+                    or extent.offset > memory_map->size()
+                    or extent.size > memory_map->size() - extent.offset;
+    if (truncated
+        or std::memcmp(header.magic, magic, sizeof(header.magic)) != 0
+        or header.byte_order != byte_order) {
+        std::cout << "Not a PRG info bundle for this machine: " << parameters.prg_info_bundle_fpath << std::endl;
+        exit(1);
+    }
+    if (header.version != prg_info_bundle_version) {
+        std::cout << "PRG info bundle version " << header.version
+                  << " is not supported (expected version " << prg_info_bundle_version << ")."
+                  << " Please re-run gramtools build." << std::endl;
+        exit(1);
+    }
+
+    // Sections read as raw arrays must hold a whole number of elements.
+    const auto &dna_bwt_occ_extent = header.sections[dna_bwt_occ_section];
+    const auto &sites_marker_info_extent = header.sections[sites_marker_info_section];
+    if (dna_bwt_occ_extent.size != (header.dna_bwt_size / DNA_BWT_Occ::block_size + 1) * sizeof(DNA_BWT_OccBlock)
+        or sites_marker_info_extent.size % sizeof(SiteMarkerInfo) != 0) {
+        std::cout << "Corrupt PRG info bundle: " << parameters.prg_info_bundle_fpath << std::endl;
+        exit(1);
+    }
+
+    PRG_Info prg_info = {};
+    prg_info.max_alphabet_num = header.max_alphabet_num;
+    prg_info.markers_mask_count_set_bits = header.markers_mask_count_set_bits;
+    prg_info.sa_sampling_interval = header.sa_sampling_interval;
+    std::copy(std::begin(header.dna_first_sa_indexes), std::end(header.dna_first_sa_indexes),
+              prg_info.dna_first_sa_indexes.begin());
+
+    const auto &sections = header.sections;
+    load_section(memory_map, sections[suffix_array_section], [&](std::istream &in) { prg_info.suffix_array.load(in); });
+    load_section(memory_map, sections[sa_samples_mask_section],
+                 [&](std::istream &in) { prg_info.sa_samples_mask.load(in); });
+    load_section(memory_map, sections[sa_samples_rank_section],
+                 [&](std::istream &in) { prg_info.sa_samples_rank.load(in, &prg_info.sa_samples_mask); });
+    load_section(memory_map, sections[bwt_markers_sa_section], [&](std::istream &in) { prg_info.bwt_markers_sa.load(in); });
+    load_section(memory_map, sections[markers_sa_section], [&](std::istream &in) { prg_info.markers_sa.load(in); });
+    load_section(memory_map, sections[encoded_prg_section], [&](std::istream &in) { prg_info.encoded_prg.load(in); });
+    load_section(memory_map, sections[sites_mask_section], [&](std::istream &in) { prg_info.sites_mask.load(in); });
+    load_section(memory_map, sections[allele_mask_section], [&](std::istream &in) { prg_info.allele_mask.load(in); });
+    load_section(memory_map, sections[bwt_markers_mask_section],
+                 [&](std::istream &in) { prg_info.bwt_markers_mask.load(in); });
+    load_section(memory_map, sections[bwt_markers_rank_section],
+                 [&](std::istream &in) { prg_info.bwt_markers_rank.load(in, &prg_info.bwt_markers_mask); });
+    load_section(memory_map, sections[bwt_markers_select_section],
+                 [&](std::istream &in) { prg_info.bwt_markers_select.load(in, &prg_info.bwt_markers_mask); });
+    load_section(memory_map, sections[bwt_markers_section], [&](std::istream &in) { prg_info.bwt_markers.load(in); });
+    load_section(memory_map, sections[prg_markers_mask_section],
+                 [&](std::istream &in) { prg_info.prg_markers_mask.load(in); });
+    load_section(memory_map, sections[prg_markers_rank_section],
+                 [&](std::istream &in) { prg_info.prg_markers_rank.load(in, &prg_info.prg_markers_mask); });
+    load_section(memory_map, sections[prg_markers_select_section],
+                 [&](std::istream &in) { prg_info.prg_markers_select.load(in, &prg_info.prg_markers_mask); });
+
+    // The occurrence table is used in place: its blocks are page aligned in the bundle.
+    prg_info.dna_bwt_occ = DNA_BWT_Occ::view(header.dna_bwt_size,
+                                             (const DNA_BWT_OccBlock *) (memory_map->data() + dna_bwt_occ_extent.offset),
+                                             dna_bwt_occ_extent.size / sizeof(DNA_BWT_OccBlock),
+                                             memory_map);
+
+    prg_info.sites_marker_info.resize(sites_marker_info_extent.size / sizeof(SiteMarkerInfo));
+    std::memcpy(prg_info.sites_marker_info.data(), memory_map->data() + sites_marker_info_extent.offset,
+                sites_marker_info_extent.size);
+    return prg_info;
+}
@@ -1,7 +1,8 @@
+#include <algorithm>
 #include <cassert>
-#include <fstream>
 #include <vector>
 
+#include "common/buffered_writer.hpp"
 #include "search/search.hpp"
 
 #include "quasimap/utils.hpp"
@@ -11,9 +12,10 @@
 using namespace gram;
 
 
-SitesAlleleBaseCoverage gram::coverage::generate::allele_base_structure(const PRG_Info &prg_info) {
+SitesAlleleBaseCoverage gram::coverage::generate::allele_base_structure(const PRG_Info &prg_info,
+                                                                        const BaseCoverageWidth &width) {
     uint64_t number_of_variant_sites = get_number_of_variant_sites(prg_info);
-    SitesAlleleBaseCoverage allele_base_coverage(number_of_variant_sites);
+    std::vector<std::vector<uint64_t>> sites_allele_sizes(number_of_variant_sites);
 
     const auto min_boundary_marker = 5;
 
@@ -34,12 +36,11 @@ SitesAlleleBaseCoverage gram::coverage::generate::allele_base_structure(const PR
             continue;
 
         // Store room aside for the allele
-        BaseCoverage bases(allele_size);
         uint64_t variant_site_cover_index = (last_marker - min_boundary_marker) / 2;
-        allele_base_coverage.at(variant_site_cover_index).emplace_back(bases);
+        sites_allele_sizes.at(variant_site_cover_index).push_back(allele_size);
         allele_size = 0;
     }
-    return allele_base_coverage;
+    return SitesAlleleBaseCoverage(sites_allele_sizes, width);
 }
 
 
@@ -62,16 +63,18 @@ uint64_t gram::set_site_base_coverage(Coverage &coverage,
     auto marker = path_element.first;
     auto min_boundary_marker = 5;
     auto variant_site_coverage_index = (marker - min_boundary_marker) / 2;
-    auto &site_coverage = coverage.allele_base_coverage.at(variant_site_coverage_index);
+    auto &allele_base_coverage = coverage.allele_base_coverage;
+    assert(variant_site_coverage_index < allele_base_coverage.size());
 
     // Extract the allele of interest using the allele id.
     auto allele_id = path_element.second;
     auto allele_coverage_index = allele_id - 1;
-    auto &allele_coverage = site_coverage.at(allele_coverage_index);
+    assert(allele_coverage_index < allele_base_coverage.count_alleles(variant_site_coverage_index));
+    auto allele_size = allele_base_coverage.allele_size(variant_site_coverage_index, allele_coverage_index);
 
     // Now: which bases inside the allele are covered by the read?
     // If `index_end_boundary` gets set to `allele_coverage_offset+max_bases_to_set`, the read ends before the allele's end.
-    uint64_t index_end_boundary = std::min(allele_coverage_offset + max_bases_to_set, allele_coverage.size());
+    uint64_t index_end_boundary = std::min(allele_coverage_offset + max_bases_to_set, allele_size);
     assert(index_end_boundary >= allele_coverage_offset);
     uint64_t count_bases_consumed = index_end_boundary - allele_coverage_offset;
 
@@ -84,29 +87,18 @@ uint64_t gram::set_site_base_coverage(Coverage &coverage,
     sites_coverage_boundaries[path_element] = index_end_boundary; // Update the end_index mapped.
 
     // Actually increment the base counts between specified ranges.
-    for (uint64_t i = index_start_boundary; i < index_end_boundary; ++i) {
-        if (allele_coverage[i] == UINT16_MAX)
-            continue;
-
-#pragma omp atomic
-        ++allele_coverage[i];
-    }
+    if (index_start_boundary < index_end_boundary)
+        allele_base_coverage.increment(variant_site_coverage_index,
+                                       allele_coverage_index,
+                                       index_start_boundary,
+                                       index_end_boundary);
     return count_bases_consumed;
 }
 
 
 std::pair<uint64_t, uint64_t> gram::site_marker_prg_indexes(const uint64_t &site_marker, const PRG_Info &prg_info) {
-    auto alphabet_rank = prg_info.fm_index.char2comp[site_marker];
-    auto first_sa_index = prg_info.fm_index.C[alphabet_rank];
-    auto second_sa_index = first_sa_index + 1;
-
-    auto first_prg_index = prg_info.fm_index[first_sa_index];
-    auto second_prg_index = prg_info.fm_index[second_sa_index];
-
-    if (first_prg_index < second_prg_index)
-        return std::make_pair(first_prg_index, second_prg_index);
-    else
-        return std::make_pair(second_prg_index, first_prg_index);
+    const auto &site_info = site_marker_info(site_marker, prg_info);
+    return std::make_pair(site_info.start_prg_index, site_info.end_prg_index);
 }
 
 
@@ -129,7 +121,7 @@ void sa_index_allele_base_coverage(Coverage &coverage,
     std::pair<uint64_t, uint64_t> site_prg_start_end = std::make_pair(0, 0);
     auto path_it = search_state.variant_site_path.begin();
 
-    auto read_start_index = prg_info.fm_index[sa_index]; // Where the mapping instance starts in the prg.
+    auto read_start_index = locate(sa_index, prg_info); // Where the mapping instance starts in the prg.
     auto start_site_marker = prg_info.sites_mask[read_start_index];
     bool read_starts_within_site = start_site_marker != 0; // Are we inside a variant site?
     if (read_starts_within_site) {
@@ -200,66 +192,75 @@ void coverage::record::allele_base(Coverage &coverage,
     }
 }
 
+void coverage::merge::allele_base(Coverage &coverage,
+                                  const std::vector<Coverage> &coverage_shards) {
+    for (const auto &coverage_shard: coverage_shards)
+        coverage.allele_base_coverage.add(coverage_shard.allele_base_coverage);
+}
+
 /**
- * String serialise the base coverages for one allele.
+ * JSON serialise the base coverages of an allele.
  */
-std::string dump_allele(const BaseCoverage &allele) {
-    std::stringstream stream;
-    stream << "[";
-    auto i = 0;
-    for (const auto &base_coverage: allele) {
-        stream << (int) base_coverage;
-        if (i++ < allele.size() - 1)
-            stream << ",";
+void dump_allele(BufferedWriter &writer,
+                 const SitesAlleleBaseCoverage &sites,
+                 const uint64_t &site_index,
+                 const uint64_t &allele_index) {
+    writer << '[';
+    auto allele_size = sites.allele_size(site_index, allele_index);
+    for (uint64_t base_index = 0; base_index < allele_size; ++base_index) {
+        writer << sites.get(site_index, allele_index, base_index);
+        if (base_index < allele_size - 1)
+            writer << ',';
     }
-    stream << "]";
-    return stream.str();
+    writer << ']';
 }
 
 /**
- * String serialise the alleles of a site.
+ * JSON serialise the alleles of a site.
  * @see dump_allele()
  */
-std::string dump_site(const AlleleCoverage &site) {
-    std::stringstream stream;
-    auto i = 0;
-    for (const auto &allele: site) {
-        stream << dump_allele(allele);
-        if (i++ < site.size() - 1)
-            stream << ",";
+void dump_site(BufferedWriter &writer, const SitesAlleleBaseCoverage &sites, const uint64_t &site_index) {
+    auto count_alleles = sites.count_alleles(site_index);
+    for (uint64_t allele_index = 0; allele_index < count_alleles; ++allele_index) {
+        dump_allele(writer, sites, site_index, allele_index);
+        if (allele_index < count_alleles - 1)
+            writer << ',';
     }
-    return stream.str();
 }
 
 /**
- * String serialise all base-level coverages for all sites of the prg.
+ * JSON serialise all base-level coverages for all sites of the prg.
  * @see dump_site()
  */
-std::string dump_sites(const SitesAlleleBaseCoverage &sites) {
-    std::stringstream stream;
-    auto i = 0;
-    for (const auto &site: sites) {
-        stream << "[";
-        stream << dump_site(site);
-        stream << "]";
-        if (i++ < sites.size() - 1)
-            stream << ",";
+void dump_sites(BufferedWriter &writer, const SitesAlleleBaseCoverage &sites) {
+    for (uint64_t site_index = 0; site_index < sites.size(); ++site_index) {
+        writer << '[';
+        dump_site(writer, sites, site_index);
+        writer << ']';
+        if (site_index < sites.size() - 1)
+            writer << ',';
     }
-    return stream.str();
+}
+
+void gram::dump_allele_base_coverage(BufferedWriter &writer, const SitesAlleleBaseCoverage &sites) {
+    writer << "{\"allele_base_counts\":[";
+    dump_sites(writer, sites);
+    writer << "]}";
 }
 
 std::string gram::dump_allele_base_coverage(const SitesAlleleBaseCoverage &sites) {
-    std::stringstream stream;
-    stream << "{\"allele_base_counts\":[";
-    stream << dump_sites(sites);
-    stream << "]}";
-    return stream.str();
+    std::string json_string;
+    {
+        BufferedWriter writer(json_string);
+        dump_allele_base_coverage(writer, sites);
+    }
+    return json_string;
 }
 
 void coverage::dump::allele_base(const Coverage &coverage,
                                  const Parameters &parameters) {
-    std::string json_string = dump_allele_base_coverage(coverage.allele_base_coverage);
-    std::ofstream file;
-    file.open(parameters.allele_base_coverage_fpath);
-    file << json_string << std::endl;
-}
\ No newline at end of file
+    BufferedWriter writer(compressed_fpath(parameters.allele_base_coverage_fpath, parameters.coverage_compression),
+                          parameters.coverage_compression);
+    dump_allele_base_coverage(writer, coverage.allele_base_coverage);
+    writer << '\n';
+}
@@ -1,7 +1,7 @@
 #include <cassert>
-#include <fstream>
 #include <vector>
 
+#include "common/buffered_writer.hpp"
 #include "search/search.hpp"
 
 #include "quasimap/utils.hpp"
@@ -53,7 +53,6 @@ void gram::coverage::record::allele_sum(Coverage &coverage,
             auto site_coverage_index = (marker - min_boundary_marker) / 2; // The variant site markers are at least 2 apart (odd numbers) so divide by 2.
             auto allele_coverage_index = allele_id - 1;
 
-            #pragma omp atomic
             allele_sum_coverage[site_coverage_index][allele_coverage_index] += 1;
             seen_sites.insert(variant_site);
         }
@@ -61,17 +60,34 @@ void gram::coverage::record::allele_sum(Coverage &coverage,
 }
 
 
+void gram::coverage::merge::allele_sum(Coverage &coverage,
+                                       const std::vector<Coverage> &coverage_shards) {
+    auto &allele_sum_coverage = coverage.allele_sum_coverage;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (uint64_t site_index = 0; site_index < allele_sum_coverage.size(); ++site_index) {
+        auto &site_coverage = allele_sum_coverage[site_index];
+        for (const auto &coverage_shard: coverage_shards) {
+            const auto &shard_site_coverage = coverage_shard.allele_sum_coverage[site_index];
+            for (uint64_t allele_index = 0; allele_index < site_coverage.size(); ++allele_index)
+                site_coverage[allele_index] += shard_site_coverage[allele_index];
+        }
+    }
+}
+
+
 void gram::coverage::dump::allele_sum(const Coverage &coverage,
                                       const Parameters &parameters) {
-    std::ofstream file_handle(parameters.allele_sum_coverage_fpath);
+    BufferedWriter writer(compressed_fpath(parameters.allele_sum_coverage_fpath, parameters.coverage_compression),
+                          parameters.coverage_compression);
     for (const auto &variant_site_coverage: coverage.allele_sum_coverage) {
         auto allele_count = 0;
         for (const auto &sum_coverage: variant_site_coverage) {
-            file_handle << sum_coverage;
+            writer << sum_coverage;
             auto not_last_coverage = allele_count++ < variant_site_coverage.size() - 1;
             if (not_last_coverage)
-                file_handle << " ";
+                writer << ' ';
         }
-        file_handle << std::endl;
+        writer << '\n';
     }
 }
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "common/utils.hpp"
+#include "quasimap/parameters.hpp"
+#include "quasimap/coverage/common.hpp"
+#include "quasimap/coverage/grouped_allele_counts.hpp"
+#include "quasimap/coverage/binary.hpp"
+
+
+using namespace gram;
+namespace po = boost::program_options;
+
+
+/** Byte size of the header: the magic, then five `uint64_t` fields. */
+constexpr uint64_t header_size = sizeof(binary_coverage_magic) + 5 * sizeof(uint64_t);
+
+
+void append_varint(std::string &buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back((char) ((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((char) value);
+}
+
+
+void append_zigzag(std::string &buffer, const int64_t &value) {
+    append_varint(buffer, ((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+}
+
+
+void append_fixed(std::string &buffer, const uint64_t &value) {
+    char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    buffer.append(bytes, sizeof(value));
+}
+
+
+/**
+ * Encodes the record of one site. Grouped allele counts are written in increasing group ID order, delta coded.
+ */
+void append_site(std::string &buffer,
+                 const uint64_t &site_index,
+                 const Coverage &coverage,
+                 const AlleleGroupHash &allele_ids_groups_hash) {
+    const auto &allele_sum_coverage = coverage.allele_sum_coverage[site_index];
+    append_varint(buffer, allele_sum_coverage.size());
+    for (const auto &sum_coverage: allele_sum_coverage)
+        append_varint(buffer, sum_coverage);
+
+    const auto &allele_base_coverage = coverage.allele_base_coverage;
+    auto count_alleles = allele_base_coverage.count_alleles(site_index);
+    append_varint(buffer, count_alleles);
+    for (uint64_t allele_index = 0; allele_index < count_alleles; ++allele_index) {
+        auto allele_size = allele_base_coverage.allele_size(site_index, allele_index);
+        append_varint(buffer, allele_size);
+        int64_t previous = 0;
+        for (uint64_t base_index = 0; base_index < allele_size; ++base_index) {
+            auto base_coverage = (int64_t) allele_base_coverage.get(site_index, allele_index, base_index);
+            append_zigzag(buffer, base_coverage - previous);
+            previous = base_coverage;
+        }
+    }
+
+    const auto &site_counts = coverage.grouped_allele_counts[site_index];
+    std::vector<std::pair<uint64_t, uint64_t>> group_counts;
+    group_counts.reserve(site_counts.size());
+    for (const auto &entry: site_counts)
+        group_counts.emplace_back(allele_ids_groups_hash.at(entry.first), entry.second);
+    std::sort(group_counts.begin(), group_counts.end());
+
+    append_varint(buffer, group_counts.size());
+    uint64_t previous_group_id = 0;
+    for (const auto &group_count: group_counts) {
+        append_varint(buffer, group_count.first - previous_group_id);
+        append_varint(buffer, group_count.second);
+        previous_group_id = group_count.first;
+    }
+}
+
+
+void gram::write_binary_coverage(const Coverage &coverage, const std::string &fpath) {
+    std::ofstream file(fpath, std::ios::binary);
+    if (not file) {
+        std::cout << "Problem opening file for writing: " << fpath << std::endl;
+        exit(1);
+    }
+
+    const auto number_of_sites = coverage.allele_sum_coverage.size();
+    auto allele_ids_groups_hash = hash_allele_groups(coverage.grouped_allele_counts);
+
+    // The header is written last, once the offsets are known.
+    file.seekp(header_size);
+    uint64_t offset = header_size;
+
+    std::vector<uint64_t> site_offsets;
+    site_offsets.reserve(number_of_sites + 1);
+    std::string buffer;
+    for (uint64_t site_index = 0; site_index < number_of_sites; ++site_index) {
+        site_offsets.push_back(offset);
+        buffer.clear();
+        append_site(buffer, site_index, coverage, allele_ids_groups_hash);
+        file.write(buffer.data(), buffer.size());
+        offset += buffer.size();
+    }
+    site_offsets.push_back(offset);
+
+    const auto groups_offset = offset;
+    std::vector<AlleleGroupKey> allele_ids_groups(allele_ids_groups_hash.size());
+    for (const auto &entry: allele_ids_groups_hash)
+        allele_ids_groups[entry.second] = entry.first;
+    buffer.clear();
+    for (const auto &allele_ids_group: allele_ids_groups) {
+        auto allele_ids = allele_group_ids(allele_ids_group);
+        append_varint(buffer, allele_ids.size());
+        int64_t previous = 0;
+        for (const auto &allele_id: allele_ids) {
+            append_zigzag(buffer, (int64_t) allele_id - previous);
+            previous = allele_id;
+        }
+    }
+    file.write(buffer.data(), buffer.size());
+    offset += buffer.size();
+
+    const auto index_offset = offset;
+    buffer.clear();
+    for (const auto &site_offset: site_offsets)
+        append_fixed(buffer, site_offset);
+    file.write(buffer.data(), buffer.size());
+
+    buffer.assign(binary_coverage_magic, sizeof(binary_coverage_magic));
+    append_fixed(buffer, binary_coverage_version);
+    append_fixed(buffer, number_of_sites);
+    append_fixed(buffer, allele_ids_groups.size());
+    append_fixed(buffer, groups_offset);
+    append_fixed(buffer, index_offset);
+    file.seekp(0);
+    file.write(buffer.data(), buffer.size());
+
+    if (not file) {
+        std::cout << "Problem writing file: " << fpath << std::endl;
+        exit(1);
+    }
+}
+
+
+void coverage::dump::binary(const Coverage &coverage,
+                            const Parameters &parameters) {
+    write_binary_coverage(coverage, parameters.binary_coverage_fpath);
+}
+
+
+/**
+ * Decodes consecutive fields from a region of the mapped file, exiting if a field runs past the region.
+ */
+class FieldReader {
+public:
+    FieldReader(const char *begin, const char *end, const std::string &fpath) : position(begin), end(end),
+                                                                                 fpath(fpath) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7) {
+            if (position == end)
+                truncated();
+            auto byte = (uint8_t) *position++;
+            value |= (uint64_t) (byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        truncated();
+        return 0;
+    }
+
+    /**
+     * Reads the number of fields which follow. Each takes at least one byte, so a count beyond the region is corrupt.
+     */
+    uint64_t count() {
+        auto value = varint();
+        if (value > (uint64_t) (end - position))
+            truncated();
+        return value;
+    }
+
+    int64_t zigzag() {
+        auto value = varint();
+        return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+    }
+
+    uint64_t fixed() {
+        if ((uint64_t) (end - position) < sizeof(uint64_t))
+            truncated();
+        uint64_t value;
+        std::memcpy(&value, position, sizeof(value));
+        position += sizeof(value);
+        return value;
+    }
+
+private:
+    const char *position;
+    const char *end;
+    const std::string &fpath;
+
+    [[noreturn]] void truncated() const {
+        std::cout << "Corrupt binary coverage file: " << fpath << std::endl;
+        exit(1);
+    }
+};
+
+
+BinaryCoverageReader::BinaryCoverageReader(const std::string &fpath) : fpath(fpath), memory_map(map_file(fpath)) {
+    const auto *data = memory_map->data();
+    const auto size = memory_map->size();
+    bool magic_matches = size >= header_size
+                         and std::memcmp(data, binary_coverage_magic, sizeof(binary_coverage_magic)) == 0;
+    if (not magic_matches) {
+        std::cout << "Not a binary coverage file: " << fpath << std::endl;
+        exit(1);
+    }
+
+    FieldReader header(data + sizeof(binary_coverage_magic), data + header_size, fpath);
+    auto version = header.fixed();
+    if (version != binary_coverage_version) {
+        std::cout << "Unsupported binary coverage format version " << version << " in: " << fpath << std::endl;
+        exit(1);
+    }
+    number_of_sites = header.fixed();
+    auto number_of_groups = header.fixed();
+    groups_offset = header.fixed();
+    auto index_offset = header.fixed();
+
+    bool index_fits = index_offset <= size
+                      and (size - index_offset) / sizeof(uint64_t) > number_of_sites
+                      and header_size <= groups_offset
+                      and groups_offset <= index_offset
+                      // Each allele group takes at least one byte.
+                      and number_of_groups <= index_offset - groups_offset;
+    if (not index_fits) {
+        std::cout << "Corrupt binary coverage file: " << fpath << std::endl;
+        exit(1);
+    }
+    index = data + index_offset;
+
+    FieldReader groups(data + groups_offset, data + index_offset, fpath);
+    allele_ids_groups.resize(number_of_groups);
+    allele_group_keys.reserve(number_of_groups);
+    for (auto &allele_ids_group: allele_ids_groups) {
+        allele_ids_group.resize(groups.count());
+        int64_t previous = 0;
+        for (auto &allele_id: allele_ids_group) {
+            previous += groups.zigzag();
+            allele_id = (AlleleId) previous;
+        }
+        allele_group_keys.push_back(allele_group_key(allele_ids_group));
+    }
+}
+
+
+uint64_t BinaryCoverageReader::site_offset(const uint64_t &site_index) const {
+    uint64_t offset;
+    std::memcpy(&offset, index + site_index * sizeof(uint64_t), sizeof(offset));
+    return offset;
+}
+
+
+SiteCoverage BinaryCoverageReader::site(const uint64_t &site_index) const {
+    const auto *data = memory_map->data();
+    auto begin = site_offset(site_index);
+    auto end = site_offset(site_index + 1);
+    if (begin < header_size or begin > end or end > groups_offset) {
+        std::cout << "Corrupt binary coverage file: " << fpath << std::endl;
+        exit(1);
+    }
+    FieldReader record(data + begin, data + end, fpath);
+
+    SiteCoverage site_coverage;
+    site_coverage.allele_sum_coverage.resize(record.count());
+    for (auto &sum_coverage: site_coverage.allele_sum_coverage)
+        sum_coverage = record.varint();
+
+    site_coverage.allele_base_coverage.resize(record.count());
+    for (auto &allele: site_coverage.allele_base_coverage) {
+        allele.resize(record.count());
+        int64_t previous = 0;
+        for (auto &base_coverage: allele) {
+            previous += record.zigzag();
+            base_coverage = (BaseCoverage::value_type) previous;
+        }
+    }
+
+    auto count_groups = record.count();
+    uint64_t group_id = 0;
+    for (uint64_t i = 0; i < count_groups; ++i) {
+        group_id += record.varint();
+        auto count = record.varint();
+        if (group_id >= allele_ids_groups.size()) {
+            std::cout << "Corrupt binary coverage file: " << fpath << std::endl;
+            exit(1);
+        }
+        site_coverage.grouped_allele_counts[allele_group_keys[group_id]] = count;
+    }
+    return site_coverage;
+}
+
+
+Coverage BinaryCoverageReader::read_all() const {
+    Coverage coverage = {};
+    coverage.allele_sum_coverage.resize(number_of_sites);
+    coverage.grouped_allele_counts.resize(number_of_sites);
+    std::vector<AlleleCoverage> allele_base_coverage(number_of_sites);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (uint64_t site_index = 0; site_index < number_of_sites; ++site_index) {
+        auto site_coverage = site(site_index);
+        coverage.allele_sum_coverage[site_index] = std::move(site_coverage.allele_sum_coverage);
+        allele_base_coverage[site_index] = std::move(site_coverage.allele_base_coverage);
+        coverage.grouped_allele_counts[site_index] = std::move(site_coverage.grouped_allele_counts);
+    }
+    coverage.allele_base_coverage = SitesAlleleBaseCoverage(allele_base_coverage);
+    return coverage;
+}
+
+
+Parameters commands::coverage_to_json::parse_parameters(po::variables_map &vm,
+                                                       const po::parsed_options &parsed) {
+    po::options_description coverage_to_json_description("coverage_to_json options");
+    coverage_to_json_description.add_options()
+                                        ("coverage", po::value<std::string>(),
+                                         "binary coverage file written by quasimap")
+                                        ("run-directory", po::value<std::string>(),
+                                         "the directory where to write the JSON coverage files")
+                                        ("coverage-compression", po::value<std::string>()->default_value("none"),
+                                         "compression of the written files: none, or gzip (adds a .gz extension)")
+                                        ("max-threads", po::value<uint32_t>()->default_value(1),
+                                         "maximum number of threads used");
+
+    std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
+                                                             po::include_positional);
+    opts.erase(opts.begin());
+    po::store(po::command_line_parser(opts).options(coverage_to_json_description).run(), vm);
+
+    Parameters parameters = {};
+    parameters.binary_coverage_fpath = vm["coverage"].as<std::string>();
+
+    std::string run_dirpath = vm["run-directory"].as<std::string>();
+    parameters.allele_sum_coverage_fpath = full_path(run_dirpath, "allele_sum_coverage");
+    parameters.allele_base_coverage_fpath = full_path(run_dirpath, "allele_base_coverage.json");
+    parameters.grouped_allele_counts_fpath = full_path(run_dirpath, "grouped_allele_counts_coverage.json");
+    parameters.coverage_format = CoverageFormat::json;
+    parameters.coverage_compression = commands::quasimap::parse_output_compression(vm["coverage-compression"].as<std::string>());
+
+    parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
+    return parameters;
+}
+
+
+void commands::coverage_to_json::run(const Parameters &parameters) {
+    std::cout << "Reading binary coverage: " << parameters.binary_coverage_fpath << std::endl;
+    BinaryCoverageReader reader(parameters.binary_coverage_fpath);
+    auto coverage = reader.read_all();
+    std::cout << "Writing JSON coverage" << std::endl;
+    coverage::dump::all(coverage, parameters);
+}
@@ -1,12 +1,12 @@
+#include <cassert>
 #include <unordered_set>
 
-#include <boost/random.hpp>
-#include <boost/generator_iterator.hpp>
 #include <boost/nondet_random.hpp>
 
 #include "quasimap/coverage/allele_sum.hpp"
 #include "quasimap/coverage/allele_base.hpp"
 #include "quasimap/coverage/grouped_allele_counts.hpp"
+#include "quasimap/coverage/binary.hpp"
 
 #include "quasimap/coverage/common.hpp"
 
@@ -25,7 +25,7 @@ bool gram::check_allele_encapsulated(const SearchState &search_state,
     for (SA_Index sa_index = search_state.sa_interval.first;
          sa_index <= search_state.sa_interval.second;
          ++sa_index) {
-        auto start_index = prg_info.fm_index[sa_index];
+        auto start_index = locate(sa_index, prg_info);
         auto start_site_marker = prg_info.sites_mask[start_index];
         auto start_allele_id = prg_info.allele_mask[start_index];
 
@@ -55,21 +55,41 @@ bool gram::multiple_allele_encapsulated(const SearchState &search_state,
 }
 
 
-SearchState random_select_single_mapping(const SearchState &search_state,
-                                         const uint32_t &random_seed) {
-    uint32_t actual_seed = 0;
-    if (random_seed == 0) {
-        boost::random_device seed_generator;
-        actual_seed = seed_generator();
-    } else {
-        actual_seed = random_seed;
-    }
-    boost::mt19937 random_number_generator(actual_seed);
+static uint64_t mix_bits(uint64_t bits) {
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111eb;
+    return bits ^ (bits >> 31);
+}
+
+
+RandomGenerator::RandomGenerator(const uint64_t &seed, const uint64_t &stream_id) {
+    // Hashing the stream id keeps streams of consecutive ids from overlapping.
+    state = mix_bits(seed ^ mix_bits(stream_id + 0x9e3779b97f4a7c15));
+}
+
+
+uint64_t RandomGenerator::next() {
+    state += 0x9e3779b97f4a7c15;
+    return mix_bits(state);
+}
+
+
+uint32_t gram::resolve_random_seed(const uint32_t &seed) {
+    if (seed != 0)
+        return seed;
+    boost::random_device seed_generator;
+    uint32_t random_seed = 0;
+    while (random_seed == 0)
+        random_seed = seed_generator();
+    return random_seed;
+}
+
 
-    boost::uniform_int<> range((int) search_state.sa_interval.first, (int) search_state.sa_interval.second);
-    using Generator = boost::variate_generator<boost::mt19937, boost::uniform_int<>>;
-    Generator generate_random_number(random_number_generator, range);
-    auto selected_sa_index = (SA_Index) generate_random_number();
+SearchState random_select_single_mapping(const SearchState &search_state,
+                                         RandomGenerator &random_generator) {
+    auto selected_sa_index = (SA_Index) random_int_inclusive(search_state.sa_interval.first,
+                                                             search_state.sa_interval.second,
+                                                             random_generator);
 
     SearchState single_mapping_search_state = search_state;
     single_mapping_search_state.sa_interval.first = selected_sa_index;
@@ -80,20 +100,11 @@ SearchState random_select_single_mapping(const SearchState &search_state,
 
 uint64_t gram::random_int_inclusive(const uint64_t &min,
                                     const uint64_t &max,
-                                    const uint64_t &random_seed) {
-    uint64_t actual_seed = 0;
-    if (random_seed == 0) {
-        boost::random_device seed_generator;
-        actual_seed = seed_generator();
-    } else {
-        actual_seed = random_seed;
-    }
-    boost::mt19937 random_number_generator((uint32_t) actual_seed);
-
-    boost::uniform_int<> range((uint32_t) min, (uint32_t) max);
-    using Generator = boost::variate_generator<boost::mt19937, boost::uniform_int<>>;
-    Generator generate_random_number(random_number_generator, range);
-    return (uint64_t) generate_random_number();
+                                    RandomGenerator &random_generator) {
+    // Maps a 64 bit draw onto the range by multiplication; the bias is negligible for ranges of mapping counts.
+    const uint64_t range_size = max - min + 1;
+    auto scaled = (unsigned __int128) random_generator.next() * range_size;
+    return min + (uint64_t) (scaled >> 64);
 }
 
 
@@ -161,7 +172,7 @@ SearchStates gram::filter_for_path_sites(const PathSites &target_path_sites,
 SearchStates selection(const SearchStates &search_states,
                        const uint64_t &read_length,
                        const PRG_Info &prg_info,
-                       const uint32_t &random_seed) {
+                       RandomGenerator &random_generator) {
     uint64_t nonvariant_count = count_nonvariant_search_states(search_states);
     // Extract the unique path sites: vectors of site IDs traversed.
     auto path_sites = get_unique_path_sites(search_states);
@@ -169,7 +180,7 @@ SearchStates selection(const SearchStates &search_states,
     uint64_t count_total_options = nonvariant_count + path_sites.size();
     if (count_total_options == 0)
         return SearchStates{};
-    uint64_t selected_option = random_int_inclusive(1, count_total_options, random_seed);
+    uint64_t selected_option = random_int_inclusive(1, count_total_options, random_generator);
 
     // If we select a non-variant path, return empty `SearchStates`, leading to no coverage information.
     bool selected_no_path = selected_option <= nonvariant_count;
@@ -192,7 +203,7 @@ SearchStates selection(const SearchStates &search_states,
     auto search_state = selected_search_states.front();
     if (multiple_allele_encapsulated(search_state, read_length, prg_info)) {
         search_state = random_select_single_mapping(search_state,
-                                                    random_seed);
+                                                    random_generator);
     }
     return SearchStates{search_state};
 }
@@ -202,11 +213,11 @@ void coverage::record::search_states(Coverage &coverage,
                                      const SearchStates &search_states,
                                      const uint64_t &read_length,
                                      const PRG_Info &prg_info,
-                                     const uint32_t &random_seed) {
+                                     RandomGenerator &random_generator) {
     SearchStates selected_search_states = selection(search_states,
                                                     read_length,
                                                     prg_info,
-                                                    random_seed);
+                                                    random_generator);
 
     coverage::record::allele_sum(coverage, selected_search_states);
     coverage::record::grouped_allele_counts(coverage, selected_search_states);
@@ -216,16 +227,35 @@ void coverage::record::search_states(Coverage &coverage,
 
 void coverage::dump::all(const Coverage &coverage,
                          const Parameters &parameters) {
+    if (parameters.coverage_format == CoverageFormat::binary) {
+        coverage::dump::binary(coverage, parameters);
+        return;
+    }
     coverage::dump::allele_sum(coverage, parameters);
     coverage::dump::allele_base(coverage, parameters);
     coverage::dump::grouped_allele_counts(coverage, parameters);
 }
 
 
-Coverage coverage::generate::empty_structure(const PRG_Info &prg_info) {
+Coverage coverage::merge::all(std::vector<Coverage> coverage_shards) {
+    assert(not coverage_shards.empty());
+    Coverage coverage = std::move(coverage_shards.front());
+    coverage_shards.erase(coverage_shards.begin());
+    if (coverage_shards.empty())
+        return coverage;
+
+    coverage::merge::allele_sum(coverage, coverage_shards);
+    coverage::merge::allele_base(coverage, coverage_shards);
+    coverage::merge::grouped_allele_counts(coverage, coverage_shards);
+    return coverage;
+}
+
+
+Coverage coverage::generate::empty_structure(const PRG_Info &prg_info,
+                                             const BaseCoverageWidth &base_coverage_width) {
     Coverage coverage = {};
     coverage.allele_sum_coverage = coverage::generate::allele_sum_structure(prg_info);
-    coverage.allele_base_coverage = coverage::generate::allele_base_structure(prg_info);
+    coverage.allele_base_coverage = coverage::generate::allele_base_structure(prg_info, base_coverage_width);
     coverage.grouped_allele_counts = coverage::generate::grouped_allele_counts(prg_info);
     return coverage;
 }
\ No newline at end of file
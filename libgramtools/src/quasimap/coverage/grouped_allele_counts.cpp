@@ -1,4 +1,4 @@
-#include <fstream>
+#include <algorithm>
 #include <vector>
 
 #include "search/search.hpp"
@@ -18,12 +18,21 @@ SitesGroupedAlleleCounts coverage::generate::grouped_allele_counts(const PRG_Inf
 }
 
 
+/**
+ * The alleles of one site traversed by a read, across all of its mapping instances.
+ */
+struct SiteAlleleGroup {
+    uint64_t site_index;
+    AlleleGroupKey bitset;
+    AlleleIds large_allele_ids; /**< Allele IDs which do not fit in `bitset`. */
+};
+
+
 void coverage::record::grouped_allele_counts(Coverage &coverage,
                                              const SearchStates &search_states) {
-    // We will store, for each variant site `Marker`, which alleles are traversed across
-    // **all** mapping instances of the processed read.
-    using AlleleIdSet = std::set<AlleleId>;
-    std::unordered_map<Marker, AlleleIdSet> site_allele_group;
+    // We will store, for each variant site, which alleles are traversed across **all** mapping instances of the
+    // processed read. A read traverses few sites, so they are searched linearly.
+    std::vector<SiteAlleleGroup> site_allele_groups;
 
     // Loop through all `SearchStates` and the variant/allele combinations in their `variant_site_path`.
     // Record which alleles are traversed for each site.
@@ -31,124 +40,203 @@ void coverage::record::grouped_allele_counts(Coverage &coverage,
         for (const auto &variant_site: search_state.variant_site_path) {
             auto site_marker = variant_site.first;
             auto allele_id = variant_site.second - 1;
-            site_allele_group[site_marker].insert(allele_id);
+
+            auto min_boundary_marker = 5;
+            // Which site entry in `grouped_allele_counts` is concerned.
+            uint64_t site_coverage_index = (site_marker - min_boundary_marker) / 2;
+
+            auto it = std::find_if(site_allele_groups.begin(), site_allele_groups.end(),
+                                   [&](const SiteAlleleGroup &group) {
+                                       return group.site_index == site_coverage_index;
+                                   });
+            if (it == site_allele_groups.end())
+                it = site_allele_groups.insert(it, SiteAlleleGroup{site_coverage_index, 0, {}});
+
+            if (allele_id < max_bitset_allele_id)
+                it->bitset |= (AlleleGroupKey) 1 << allele_id;
+            else
+                it->large_allele_ids.push_back(allele_id);
         }
     }
 
-    // Loop through the variant site markers traversed at least once by the read.
-    for (const auto &entry: site_allele_group) {
-        auto site_marker = entry.first;
-        auto allele_ids_set = entry.second;
-        AlleleIds allele_ids;
-        std::copy(allele_ids_set.begin(), allele_ids_set.end(),
-                  std::back_inserter(allele_ids));
-
-        auto min_boundary_marker = 5;
-        // Which site entry in `grouped_allele_counts` is concerned.
-        auto site_coverage_index = (site_marker - min_boundary_marker) / 2;
-
-        // Get the map between allele Ids and counts.
-        auto &site_coverage = coverage.grouped_allele_counts[site_coverage_index];
-        #pragma omp critical
+    // Loop through the variant sites traversed at least once by the read.
+    for (const auto &site_allele_group: site_allele_groups) {
+        AlleleGroupKey key = site_allele_group.bitset;
+        if (not site_allele_group.large_allele_ids.empty()) {
+            auto allele_ids = allele_group_ids(site_allele_group.bitset);
+            allele_ids.insert(allele_ids.end(),
+                              site_allele_group.large_allele_ids.begin(),
+                              site_allele_group.large_allele_ids.end());
+            std::sort(allele_ids.begin(), allele_ids.end());
+            allele_ids.erase(std::unique(allele_ids.begin(), allele_ids.end()), allele_ids.end());
+            key = allele_group_key(allele_ids);
+        }
+
         // Note: if the key does not already exists, creates a key value pair **and** initialises the value to 0.
-        site_coverage[allele_ids] += 1;
+        coverage.grouped_allele_counts[site_allele_group.site_index][key] += 1;
+    }
+}
+
+
+void coverage::merge::grouped_allele_counts(Coverage &coverage,
+                                            const std::vector<Coverage> &coverage_shards) {
+    auto &grouped_allele_counts = coverage.grouped_allele_counts;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (uint64_t site_index = 0; site_index < grouped_allele_counts.size(); ++site_index) {
+        auto &site_coverage = grouped_allele_counts[site_index];
+        for (const auto &coverage_shard: coverage_shards) {
+            for (const auto &entry: coverage_shard.grouped_allele_counts[site_index])
+                site_coverage[entry.first] += entry.second;
+        }
     }
 }
 
 
+/**
+ * The allele groups of a site in lexicographic order: the iteration order of the hash map depends on insertion history.
+ */
+std::vector<AlleleGroupKey> get_sorted_allele_groups(const GroupedAlleleCounts &site) {
+    std::vector<AlleleGroupKey> allele_groups;
+    allele_groups.reserve(site.size());
+    for (const auto &allele_entry: site)
+        allele_groups.push_back(allele_entry.first);
+    std::sort(allele_groups.begin(), allele_groups.end(), allele_group_less);
+    return allele_groups;
+}
+
+
 AlleleGroupHash gram::hash_allele_groups(const SitesGroupedAlleleCounts &sites) {
     AlleleGroupHash allele_ids_groups_hash;
     uint64_t group_ID = 0;
     // Loop through all allele id groups across all variant sites.
     for (const auto &site: sites) {
-        for (const auto &allele_group: site) {
-            auto allele_ids_group = allele_group.first;
-            auto group_seen = allele_ids_groups_hash.find(allele_ids_group)
-                              != allele_ids_groups_hash.end();
-            // Group already has an ID, continue.
-            if (group_seen)
-                continue;
-            allele_ids_groups_hash[allele_ids_group] = group_ID++;
+        for (const auto &allele_group: get_sorted_allele_groups(site)) {
+            // A group which already has an ID keeps it.
+            auto inserted = allele_ids_groups_hash.emplace(allele_group, group_ID);
+            if (inserted.second)
+                ++group_ID;
         }
     }
     return allele_ids_groups_hash;
 }
 
 
-std::string gram::dump_site(const AlleleGroupHash &allele_ids_groups_hash,
-                            const GroupedAlleleCounts &site) {
-    std::stringstream stream;
-    stream << "{";
-    auto i = 0;
-    for (const auto &allele_entry: site) {
-        auto allele_ids_group = allele_entry.first;
-        uint64_t group_ID = allele_ids_groups_hash.at(allele_ids_group);
-        auto count = allele_entry.second;
-
-        stream << "\"" << (int) group_ID << "\":" << (int) count;
+/**
+ * Collects the output of a writer based dump function into a string.
+ */
+template<typename Dump>
+std::string dump_to_string(Dump dump) {
+    std::string json_string;
+    {
+        BufferedWriter writer(json_string);
+        dump(writer);
+    }
+    return json_string;
+}
+
+
+void gram::dump_site(BufferedWriter &writer,
+                     const AlleleGroupHash &allele_ids_groups_hash,
+                     const GroupedAlleleCounts &site) {
+    std::vector<std::pair<uint64_t, uint64_t>> group_counts;
+    group_counts.reserve(site.size());
+    for (const auto &allele_entry: site)
+        group_counts.emplace_back(allele_ids_groups_hash.at(allele_entry.first), allele_entry.second);
+    std::sort(group_counts.begin(), group_counts.end());
+
+    writer << '{';
+    uint64_t i = 0;
+    for (const auto &group_count: group_counts) {
+        auto group_ID = group_count.first;
+        auto count = group_count.second;
+
+        writer << '"' << group_ID << "\":" << count;
         if (i++ < site.size() - 1)
-            stream << ",";
+            writer << ',';
     }
-    stream << "}";
-    return stream.str();
+    writer << '}';
 }
 
 
-std::string gram::dump_site_counts(const AlleleGroupHash &allele_ids_groups_hash,
-                                   const SitesGroupedAlleleCounts &sites) {
-    std::stringstream stream;
-    stream << "\"site_counts\":[";
-    auto i = 0;
+std::string gram::dump_site(const AlleleGroupHash &allele_ids_groups_hash,
+                            const GroupedAlleleCounts &site) {
+    return dump_to_string([&](BufferedWriter &writer) { dump_site(writer, allele_ids_groups_hash, site); });
+}
+
+
+void gram::dump_site_counts(BufferedWriter &writer,
+                            const AlleleGroupHash &allele_ids_groups_hash,
+                            const SitesGroupedAlleleCounts &sites) {
+    writer << "\"site_counts\":[";
+    uint64_t i = 0;
     // Call dump_site() for each site, regardless of whether it has any coverage information at all.
     for (const auto &site: sites) {
-        stream << dump_site(allele_ids_groups_hash, site);
+        dump_site(writer, allele_ids_groups_hash, site);
         if (i++ < sites.size() - 1)
-            stream << ",";
+            writer << ',';
     }
-    stream << "]";
-    return stream.str();
+    writer << ']';
 }
 
 
-std::string gram::dump_allele_groups(const AlleleGroupHash &allele_ids_groups_hash) {
-    std::stringstream stream;
-    stream << "\"allele_groups\":{";
-    auto i = 0;
-    for (const auto &entry: allele_ids_groups_hash) {
-        auto allele_ids_group = entry.first;
-        uint64_t group_hash = entry.second;
-        stream << "\"" << (int) group_hash << "\":[";
-        auto j = 0;
+std::string gram::dump_site_counts(const AlleleGroupHash &allele_ids_groups_hash,
+                                   const SitesGroupedAlleleCounts &sites) {
+    return dump_to_string([&](BufferedWriter &writer) { dump_site_counts(writer, allele_ids_groups_hash, sites); });
+}
+
+
+void gram::dump_allele_groups(BufferedWriter &writer, const AlleleGroupHash &allele_ids_groups_hash) {
+    std::vector<std::pair<uint64_t, AlleleGroupKey>> allele_ids_groups;
+    allele_ids_groups.reserve(allele_ids_groups_hash.size());
+    for (const auto &entry: allele_ids_groups_hash)
+        allele_ids_groups.emplace_back(entry.second, entry.first);
+    std::sort(allele_ids_groups.begin(), allele_ids_groups.end());
+
+    writer << "\"allele_groups\":{";
+    uint64_t i = 0;
+    for (const auto &entry: allele_ids_groups) {
+        auto group_hash = entry.first;
+        auto allele_ids_group = allele_group_ids(entry.second);
+        writer << '"' << group_hash << "\":[";
+        uint64_t j = 0;
         for (const auto &allele_id: allele_ids_group) {
-            stream << (int) allele_id;
+            writer << allele_id;
             if (j++ < allele_ids_group.size() - 1)
-                stream << ",";
+                writer << ',';
         }
-        stream << "]";
+        writer << ']';
         if (i++ < allele_ids_groups_hash.size() - 1)
-            stream << ",";
+            writer << ',';
     }
-    stream << "}";
-    return stream.str();
+    writer << '}';
 }
 
 
-std::string gram::dump_grouped_allele_counts(const SitesGroupedAlleleCounts &sites) {
+std::string gram::dump_allele_groups(const AlleleGroupHash &allele_ids_groups_hash) {
+    return dump_to_string([&](BufferedWriter &writer) { dump_allele_groups(writer, allele_ids_groups_hash); });
+}
+
+
+void gram::dump_grouped_allele_counts(BufferedWriter &writer, const SitesGroupedAlleleCounts &sites) {
     auto allele_ids_groups_hash = hash_allele_groups(sites);
-    std::stringstream stream;
-    stream << "{\"grouped_allele_counts\":{";
-    stream << dump_site_counts(allele_ids_groups_hash, sites);
-    stream << ",";
-    stream << dump_allele_groups(allele_ids_groups_hash);
-    stream << "}}";
-    return stream.str();
+    writer << "{\"grouped_allele_counts\":{";
+    dump_site_counts(writer, allele_ids_groups_hash, sites);
+    writer << ',';
+    dump_allele_groups(writer, allele_ids_groups_hash);
+    writer << "}}";
+}
+
+
+std::string gram::dump_grouped_allele_counts(const SitesGroupedAlleleCounts &sites) {
+    return dump_to_string([&](BufferedWriter &writer) { dump_grouped_allele_counts(writer, sites); });
 }
 
 
 void coverage::dump::grouped_allele_counts(const Coverage &coverage,
                                            const Parameters &parameters) {
-    std::string json_string = dump_grouped_allele_counts(coverage.grouped_allele_counts);
-    std::ofstream file;
-    file.open(parameters.grouped_allele_counts_fpath);
-    file << json_string << std::endl;
-}
\ No newline at end of file
+    BufferedWriter writer(compressed_fpath(parameters.grouped_allele_counts_fpath, parameters.coverage_compression),
+                          parameters.coverage_compression);
+    dump_grouped_allele_counts(writer, coverage.grouped_allele_counts);
+    writer << '\n';
+}
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+
+#include "quasimap/coverage/types.hpp"
+
+
+using namespace gram;
+
+
+/**
+ * The allele groups which do not fit a bitset, and so only occur at sites with many alleles.
+ * Groups are added, never removed, so an index stays valid for the life of the process.
+ */
+class InternedAlleleGroups {
+public:
+    uint64_t intern(const AlleleIds &allele_ids) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = indexes.find(allele_ids);
+            if (it != indexes.end())
+                return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto inserted = indexes.emplace(allele_ids, groups.size());
+        if (inserted.second)
+            groups.push_back(allele_ids);
+        return inserted.first->second;
+    }
+
+    AlleleIds get(const uint64_t &index) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return groups.at(index);
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    SequenceHashMap<AlleleIds, uint64_t> indexes;
+    std::deque<AlleleIds> groups;
+};
+
+
+InternedAlleleGroups &get_interned_allele_groups() {
+    static InternedAlleleGroups interned_allele_groups;
+    return interned_allele_groups;
+}
+
+
+constexpr AlleleGroupKey interned_group_flag = (AlleleGroupKey) 1 << 63;
+
+
+AlleleGroupKey gram::allele_group_key(const AlleleIds &allele_ids) {
+    AlleleGroupKey bitset = 0;
+    for (const auto &allele_id: allele_ids) {
+        if (allele_id >= max_bitset_allele_id)
+            return interned_group_flag | get_interned_allele_groups().intern(allele_ids);
+        bitset |= (AlleleGroupKey) 1 << allele_id;
+    }
+    return bitset;
+}
+
+
+AlleleIds gram::allele_group_ids(const AlleleGroupKey &key) {
+    if ((key & interned_group_flag) != 0)
+        return get_interned_allele_groups().get(key & ~interned_group_flag);
+
+    AlleleIds allele_ids;
+    for (auto bitset = key; bitset != 0; bitset &= bitset - 1)
+        allele_ids.push_back((AlleleId) __builtin_ctzll(bitset));
+    return allele_ids;
+}
+
+
+bool gram::allele_group_less(const AlleleGroupKey &lhs, const AlleleGroupKey &rhs) {
+    bool both_bitsets = ((lhs | rhs) & interned_group_flag) == 0;
+    if (not both_bitsets)
+        return allele_group_ids(lhs) < allele_group_ids(rhs);
+
+    // Compares allele IDs from the lowest, as a lexicographic comparison of the sorted IDs would.
+    auto lhs_bits = lhs;
+    auto rhs_bits = rhs;
+    while (lhs_bits != 0 and rhs_bits != 0) {
+        auto lhs_id = __builtin_ctzll(lhs_bits);
+        auto rhs_id = __builtin_ctzll(rhs_bits);
+        if (lhs_id != rhs_id)
+            return lhs_id < rhs_id;
+        lhs_bits &= lhs_bits - 1;
+        rhs_bits &= rhs_bits - 1;
+    }
+    return lhs_bits == 0 and rhs_bits != 0;
+}
+
+
+std::ostream &gram::operator<<(std::ostream &stream, const GroupedAlleleCounts &site) {
+    stream << "{";
+    for (const auto &entry: site) {
+        stream << " {";
+        for (const auto &allele_id: allele_group_ids(entry.first))
+            stream << " " << allele_id;
+        stream << " }: " << entry.second;
+    }
+    stream << " }";
+    return stream;
+}
+
+
+SitesAlleleBaseCoverage::SitesAlleleBaseCoverage(const std::vector<std::vector<uint64_t>> &sites_allele_sizes,
+                                                 const BaseCoverageWidth &width) : counter_width(width) {
+    site_offsets.reserve(sites_allele_sizes.size() + 1);
+    site_offsets.push_back(0);
+    allele_offsets.push_back(0);
+    for (const auto &allele_sizes: sites_allele_sizes) {
+        for (const auto &allele_size: allele_sizes)
+            allele_offsets.push_back(allele_offsets.back() + allele_size);
+        site_offsets.push_back(allele_offsets.size() - 1);
+    }
+
+    auto count_counters = allele_offsets.back();
+    if (counter_width == BaseCoverageWidth::bits16)
+        counters16.assign(count_counters, 0);
+    else
+        counters32.assign(count_counters, 0);
+}
+
+
+/**
+ * The allele sizes of nested per site coverage.
+ */
+std::vector<std::vector<uint64_t>> get_sites_allele_sizes(const std::vector<AlleleCoverage> &sites) {
+    std::vector<std::vector<uint64_t>> sites_allele_sizes;
+    sites_allele_sizes.reserve(sites.size());
+    for (const auto &site: sites) {
+        std::vector<uint64_t> allele_sizes;
+        allele_sizes.reserve(site.size());
+        for (const auto &allele: site)
+            allele_sizes.push_back(allele.size());
+        sites_allele_sizes.emplace_back(std::move(allele_sizes));
+    }
+    return sites_allele_sizes;
+}
+
+
+SitesAlleleBaseCoverage::SitesAlleleBaseCoverage(const std::vector<AlleleCoverage> &sites,
+                                                 const BaseCoverageWidth &width)
+        : SitesAlleleBaseCoverage(get_sites_allele_sizes(sites), width) {
+    uint64_t counter = 0;
+    for (const auto &site: sites) {
+        for (const auto &allele: site) {
+            for (const auto &base_coverage: allele) {
+                if (counter_width == BaseCoverageWidth::bits16)
+                    counters16[counter++] = (uint16_t) std::min<uint64_t>(base_coverage, UINT16_MAX);
+                else
+                    counters32[counter++] = base_coverage;
+            }
+        }
+    }
+}
+
+
+/**
+ * Adds `source` into `target` element-wise, saturating at the maximum value of the target's counters.
+ */
+template<typename TargetCounter, typename SourceCounter>
+void add_counters(std::vector<TargetCounter> &target, const std::vector<SourceCounter> &source) {
+    const uint64_t max_count = std::numeric_limits<TargetCounter>::max();
+    #pragma omp parallel for schedule(static)
+    for (uint64_t i = 0; i < target.size(); ++i) {
+        uint64_t count = (uint64_t) target[i] + source[i];
+        target[i] = (TargetCounter) std::min(count, max_count);
+    }
+}
+
+
+void SitesAlleleBaseCoverage::add(const SitesAlleleBaseCoverage &other) {
+    assert(site_offsets == other.site_offsets and allele_offsets == other.allele_offsets);
+    bool target16 = counter_width == BaseCoverageWidth::bits16;
+    bool source16 = other.counter_width == BaseCoverageWidth::bits16;
+    if (target16 and source16)
+        add_counters(counters16, other.counters16);
+    else if (target16)
+        add_counters(counters16, other.counters32);
+    else if (source16)
+        add_counters(counters32, other.counters16);
+    else
+        add_counters(counters32, other.counters32);
+}
+
+
+AlleleCoverage SitesAlleleBaseCoverage::site(const uint64_t &site_index) const {
+    AlleleCoverage site_coverage(count_alleles(site_index));
+    for (uint64_t allele_index = 0; allele_index < site_coverage.size(); ++allele_index) {
+        auto &allele_coverage = site_coverage[allele_index];
+        allele_coverage.resize(allele_size(site_index, allele_index));
+        for (uint64_t base_index = 0; base_index < allele_coverage.size(); ++base_index)
+            allele_coverage[base_index] = (uint32_t) get(site_index, allele_index, base_index);
+    }
+    return site_coverage;
+}
+
+
+bool SitesAlleleBaseCoverage::operator==(const SitesAlleleBaseCoverage &other) const {
+    // Structures without sites may not have their offsets initialised.
+    if (empty() or other.empty())
+        return empty() and other.empty();
+    if (site_offsets != other.site_offsets or allele_offsets != other.allele_offsets)
+        return false;
+    for (uint64_t i = 0; i < allele_offsets.back(); ++i) {
+        auto count = counter_width == BaseCoverageWidth::bits16 ? counters16[i] : counters32[i];
+        auto other_count = other.counter_width == BaseCoverageWidth::bits16 ? other.counters16[i] : other.counters32[i];
+        if (count != other_count)
+            return false;
+    }
+    return true;
+}
+
+
+std::ostream &gram::operator<<(std::ostream &stream, const SitesAlleleBaseCoverage &sites) {
+    stream << "{";
+    for (uint64_t site_index = 0; site_index < sites.size(); ++site_index) {
+        stream << (site_index == 0 ? " {" : ", {");
+        auto site_coverage = sites.site(site_index);
+        for (uint64_t allele_index = 0; allele_index < site_coverage.size(); ++allele_index) {
+            stream << (allele_index == 0 ? " {" : ", {");
+            for (uint64_t base_index = 0; base_index < site_coverage[allele_index].size(); ++base_index)
+                stream << (base_index == 0 ? " " : ", ") << site_coverage[allele_index][base_index];
+            stream << " }";
+        }
+        stream << " }";
+    }
+    stream << " }";
+    return stream;
+}
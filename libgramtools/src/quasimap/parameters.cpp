@@ -21,7 +21,19 @@ Parameters commands::quasimap::parse_parameters(po::variables_map &vm,
                                 ("max-threads", po::value<uint32_t>()->default_value(1),
                                  "maximum number of threads used")
                                 ("seed", po::value<uint32_t>()->default_value(0),
-                                        "seed for pseudo-random selection of multi-mapping reads. the default of 0 produces a random seed.");
+                                        "seed for pseudo-random selection of multi-mapping reads. the default of 0 produces a random seed.")
+                                ("reads-batch-size", po::value<uint64_t>()->default_value(5000),
+                                 "number of reads parsed and mapped together")
+                                ("reads-queue-depth", po::value<uint64_t>()->default_value(4),
+                                 "number of parsed read batches which can wait to be mapped")
+                                ("decompression-threads", po::value<uint32_t>()->default_value(4),
+                                 "threads decompressing BGZF reads files; gzip files are decompressed on one thread")
+                                ("coverage-format", po::value<std::string>()->default_value("json"),
+                                 "format of the coverage output: json, or binary (convert with the coverage_to_json command)")
+                                ("coverage-compression", po::value<std::string>()->default_value("none"),
+                                 "compression of json coverage files: none, or gzip (adds a .gz extension)")
+                                ("base-coverage-width", po::value<uint32_t>()->default_value(32),
+                                 "bits per base-level coverage counter: 16 or 32. counts saturate at the maximum value");
 
     std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
                                                              po::include_positional);
@@ -37,6 +49,7 @@ Parameters commands::quasimap::parse_parameters(po::variables_map &vm,
     parameters.fm_index_fpath = full_path(gram_dirpath, "fm_index");
     parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
     parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
+    parameters.prg_info_bundle_fpath = full_path(gram_dirpath, "prg_info");
     parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
     parameters.kmers_fpath = full_path(gram_dirpath, "kmers");
     parameters.kmers_stats_fpath = full_path(gram_dirpath, "kmers_stats");
@@ -52,10 +65,40 @@ Parameters commands::quasimap::parse_parameters(po::variables_map &vm,
     parameters.allele_sum_coverage_fpath = full_path(run_dirpath, "allele_sum_coverage");
     parameters.allele_base_coverage_fpath = full_path(run_dirpath, "allele_base_coverage.json");
     parameters.grouped_allele_counts_fpath = full_path(run_dirpath, "grouped_allele_counts_coverage.json");
+    parameters.binary_coverage_fpath = full_path(run_dirpath, "coverage.bin");
     
     parameters.read_stats_fpath = full_path(run_dirpath, "read_stats.json");
 
     parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
     parameters.seed = vm["seed"].as<uint32_t>();
+    parameters.reads_batch_size = vm["reads-batch-size"].as<uint64_t>();
+    parameters.reads_queue_depth = vm["reads-queue-depth"].as<uint64_t>();
+    parameters.decompression_threads = vm["decompression-threads"].as<uint32_t>();
+
+    std::string coverage_format = vm["coverage-format"].as<std::string>();
+    if (coverage_format == "json")
+        parameters.coverage_format = CoverageFormat::json;
+    else if (coverage_format == "binary")
+        parameters.coverage_format = CoverageFormat::binary;
+    else
+        throw po::invalid_option_value(coverage_format);
+    parameters.coverage_compression = commands::quasimap::parse_output_compression(vm["coverage-compression"].as<std::string>());
+
+    auto base_coverage_width = vm["base-coverage-width"].as<uint32_t>();
+    if (base_coverage_width == 16)
+        parameters.base_coverage_width = BaseCoverageWidth::bits16;
+    else if (base_coverage_width == 32)
+        parameters.base_coverage_width = BaseCoverageWidth::bits32;
+    else
+        throw po::invalid_option_value(std::to_string(base_coverage_width));
     return parameters;
-}
\ No newline at end of file
+}
+
+
+OutputCompression commands::quasimap::parse_output_compression(const std::string &compression) {
+    if (compression == "none")
+        return OutputCompression::none;
+    if (compression == "gzip")
+        return OutputCompression::gzip;
+    throw po::invalid_option_value(compression);
+}
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cassert>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <omp.h>
 
@@ -10,6 +13,8 @@
 #include "common/parameters.hpp"
 #include "common/utils.hpp"
 #include "common/read_stats.hpp"
+#include "common/bounded_queue.hpp"
+#include "common/decompression.hpp"
 
 #include "search/search.hpp"
 
@@ -27,15 +32,16 @@ void commands::quasimap::run(const Parameters &parameters) {
     auto timer = TimerReport();
    
     ReadStats readstats;
-    
-    std::string first_reads_fpath = parameters.reads_fpaths[0];
-    readstats.compute_base_error_rate(first_reads_fpath);
 
     timer.start("Load data");
     std::cout << "Loading PRG data" << std::endl;
     const auto prg_info = load_prg_info(parameters);
     std::cout << "Loading kmer index data" << std::endl;
-    const auto kmer_index = kmer_index::load(parameters);
+    auto kmer_index = kmer_index::load(parameters);
+    if (use_direct_lookup(kmer_index.kmer_size, prg_info.dna_bwt_occ.size())) {
+        std::cout << "Building direct kmer lookup table" << std::endl;
+        kmer_index.build_direct_lookup();
+    }
     timer.stop();
 
     std::cout << "Running quasimap" << std::endl;
@@ -63,10 +69,19 @@ QuasimapReadsStats gram::quasimap_reads(const Parameters &parameters,
                                         const PRG_Info &prg_info,
                                         ReadStats &readstats) {
     std::cout << "Generating allele quasimap data structure" << std::endl;
-    // The coverage structure records mapped allele counts (per site), aggregated from all mapped reads
-    auto coverage = coverage::generate::empty_structure(prg_info);
+    // The coverage structure records mapped allele counts (per site), aggregated from all mapped reads.
+    // Each thread records into its own shard, so that no synchronisation is needed while mapping.
+    std::vector<Coverage> coverage_shards;
+    coverage_shards.reserve(omp_get_max_threads());
+    for (int i = 0; i < omp_get_max_threads(); ++i)
+        coverage_shards.emplace_back(coverage::generate::empty_structure(prg_info, parameters.base_coverage_width));
     std::cout << "Done generating allele quasimap data structure" << std::endl;
 
+    // A seed of 0 is replaced once, so that the random streams of all reads derive from the same seed.
+    auto mapping_parameters = parameters;
+    mapping_parameters.seed = resolve_random_seed(parameters.seed);
+    std::cout << "Random seed: " << mapping_parameters.seed << std::endl;
+
     std::cout << "Processing reads:" << std::endl;
     // QuasimapReadsStats records counts of processed reads, skipped reads and mapped reads
     QuasimapReadsStats quasimap_stats = {};
@@ -74,14 +89,17 @@ QuasimapReadsStats gram::quasimap_reads(const Parameters &parameters,
     // Execute quasimap for each read file provided
     for (const auto &reads_fpath: parameters.reads_fpaths) {
         handle_read_file(quasimap_stats,
-                         coverage,
+                         coverage_shards,
+                         readstats,
                          reads_fpath,
-                         parameters,
+                         mapping_parameters,
                          kmer_index,
                          prg_info);
     }
+    auto coverage = coverage::merge::all(std::move(coverage_shards));
     
     //Compute read mapping statistics (used in `infer` command)
+    readstats.compute_base_error_rate();
     readstats.compute_coverage_depth(coverage);
     
     // Write coverage results to disk
@@ -90,15 +108,27 @@ QuasimapReadsStats gram::quasimap_reads(const Parameters &parameters,
 }
 
 
+/**
+ * SAM, BAM and CRAM files are read by htslib, which handles their compression.
+ */
+bool is_hts_reads_file(const std::string &reads_fpath) {
+    auto format = seq_guess_filetype_from_extension(reads_fpath.c_str());
+    return format == SEQ_FMT_SAM or format == SEQ_FMT_BAM or format == SEQ_FMT_CRAM;
+}
+
+
 /**
  * Emplace up to `max_set_size` reads into the reads buffer.
  * Returns a vector of `Pattern`s: a `Pattern` being a vector of `Base`s, which are integer encoded.
  * The encoding of DNA letters to integers also performed in this function.
+ * The length and base qualities of each read are recorded into `readstats`.
  */
-std::vector<Pattern> get_reads_buffer(SeqRead::SeqIterator &reads_it, SeqRead &reads, const uint64_t &max_set_size) {
+std::vector<Pattern> get_reads_buffer(SeqRead::SeqIterator &reads_it, SeqRead &reads, const uint64_t &max_set_size,
+                                      ReadStats &readstats) {
     std::vector<Pattern> reads_buffer;
     while (reads_it != reads.end() and reads_buffer.size() < max_set_size) {
         const auto *const raw_read = *reads_it;
+        readstats.record_read(*raw_read);
         auto read = encode_dna_bases(*raw_read);
         reads_buffer.emplace_back(read);
         ++reads_it;
@@ -108,14 +138,17 @@ std::vector<Pattern> get_reads_buffer(SeqRead::SeqIterator &reads_it, SeqRead &r
 
 /**
  * Calls the (forward_reverse) mapping routine for each read in the read buffer, in parallel (if the CL option has been specified).
+ * Each thread records coverage into its own shard of `coverage_shards`.
  */
 void handle_reads_buffer(QuasimapReadsStats &quasimap_stats,
-                         Coverage &coverage,
+                         std::vector<Coverage> &coverage_shards,
                          const std::vector<Pattern> &reads_buffer,
                          const Parameters &parameters,
                          const KmerIndex &kmer_index,
                          const PRG_Info &prg_info) {
     uint64_t last_count_reported = 0;
+    // Reads are numbered in input order across all read files: all previous buffers have been fully processed.
+    const uint64_t first_read_id = quasimap_stats.all_reads_count / 2;
 
     //  Parallelise loop below
     #pragma omp parallel for
@@ -142,43 +175,112 @@ void handle_reads_buffer(QuasimapReadsStats &quasimap_stats,
             continue;
         }
         quasimap_forward_reverse(quasimap_stats,
-                                 coverage,
+                                 coverage_shards[thread_id],
                                  read,
+                                 first_read_id + i,
                                  parameters,
                                  kmer_index,
                                  prg_info);
     }
 }
 
+/**
+ * Closes the reads queue, then joins the reader thread, on leaving scope.
+ */
+template<typename T>
+class ReaderJoinGuard {
+public:
+    ReaderJoinGuard(std::thread &reader, BoundedQueue<T> &queue) : reader(reader), queue(queue) {}
+
+    ReaderJoinGuard(const ReaderJoinGuard &) = delete;
+
+    ReaderJoinGuard &operator=(const ReaderJoinGuard &) = delete;
+
+    ~ReaderJoinGuard() {
+        queue.close();
+        if (reader.joinable())
+            reader.join();
+    }
+
+private:
+    std::thread &reader;
+    BoundedQueue<T> &queue;
+};
+
+
 void gram::handle_read_file(QuasimapReadsStats &quasimap_stats,
-                            Coverage &coverage,
+                            std::vector<Coverage> &coverage_shards,
+                            ReadStats &readstats,
                             const std::string &reads_fpath,
                             const Parameters &parameters,
                             const KmerIndex &kmer_index,
                             const PRG_Info &prg_info) {
     //  Number of reads to load in memory; is upper limit of number of reads that can be mapped in parallel
-    uint64_t max_set_size = 5000;
-    SeqRead reads(reads_fpath.c_str());
-    auto reads_it = reads.begin();
-    while (reads_it != reads.end()) {
-        auto reads_buffer = get_reads_buffer(reads_it, reads, max_set_size);
-        handle_reads_buffer(quasimap_stats,
-                            coverage,
-                            reads_buffer,
-                            parameters,
-                            kmer_index,
-                            prg_info);
+    uint64_t max_set_size = std::max<uint64_t>(1, parameters.reads_batch_size);
+    BoundedQueue<std::vector<Pattern>> reads_buffers(parameters.reads_queue_depth);
+
+    // A reader thread parses and encodes the next buffers while the mapping threads process the current one.
+    // It records read statistics into its own object, combined once all reads are parsed.
+    ReadStats reader_readstats;
+    std::exception_ptr reader_exception;
+    std::thread reader([&]() {
+        try {
+            auto push_reads_buffers = [&](SeqRead &reads) {
+                auto reads_it = reads.begin();
+                while (reads_it != reads.end()) {
+                    if (not reads_buffers.push(get_reads_buffer(reads_it, reads, max_set_size, reader_readstats)))
+                        return;
+                }
+            };
+
+            // Compressed FASTA/FASTQ is decompressed on other threads, and parsed from a pipe.
+            auto compression_format = CompressionFormat::none;
+            if (not is_hts_reads_file(reads_fpath))
+                compression_format = detect_compression_format(reads_fpath);
+            if (compression_format == CompressionFormat::none) {
+                SeqRead reads(reads_fpath.c_str());
+                push_reads_buffers(reads);
+            } else {
+                DecompressionPipe decompression_pipe(reads_fpath,
+                                                     compression_format,
+                                                     parameters.decompression_threads);
+                SeqRead reads(decompression_pipe.release_read_descriptor());
+                push_reads_buffers(reads);
+            }
+        } catch (...) {
+            reader_exception = std::current_exception();
+        }
+        reads_buffers.close();
+    });
+
+    {
+        // Also joins the reader if mapping throws: the queue is closed first so that the reader is not left blocked.
+        ReaderJoinGuard<std::vector<Pattern>> reader_join_guard(reader, reads_buffers);
+
+        std::vector<Pattern> reads_buffer;
+        while (reads_buffers.pop(reads_buffer)) {
+            handle_reads_buffer(quasimap_stats,
+                                coverage_shards,
+                                reads_buffer,
+                                parameters,
+                                kmer_index,
+                                prg_info);
+        }
     }
+    if (reader_exception)
+        std::rethrow_exception(reader_exception);
+    readstats.add_read_stats(reader_readstats);
 }
 
 void gram::quasimap_forward_reverse(QuasimapReadsStats &quasimap_reads_stats,
                                     Coverage &coverage,
                                     const Pattern &read,
+                                    const uint64_t &read_id,
                                     const Parameters &parameters,
                                     const KmerIndex &kmer_index,
                                     const PRG_Info &prg_info) {
     // Forward mapping
-    bool read_mapped_exactly = quasimap_read(read, coverage, kmer_index, prg_info, parameters);
+    bool read_mapped_exactly = quasimap_read(read, coverage, kmer_index, prg_info, parameters, 2 * read_id);
     if (read_mapped_exactly) {
         #pragma omp atomic
         ++quasimap_reads_stats.mapped_reads_count;
@@ -186,7 +288,7 @@ void gram::quasimap_forward_reverse(QuasimapReadsStats &quasimap_reads_stats,
 
     auto reverse_read = reverse_complement_read(read);
     // Reverse mapping
-    read_mapped_exactly = quasimap_read(reverse_read, coverage, kmer_index, prg_info, parameters);
+    read_mapped_exactly = quasimap_read(reverse_read, coverage, kmer_index, prg_info, parameters, 2 * read_id + 1);
     if (read_mapped_exactly) {
         #pragma omp atomic
         ++quasimap_reads_stats.mapped_reads_count;
@@ -197,7 +299,8 @@ bool gram::quasimap_read(const Pattern &read,
                          Coverage &coverage,
                          const KmerIndex &kmer_index,
                          const PRG_Info &prg_info,
-                         const Parameters &parameters) {
+                         const Parameters &parameters,
+                         const uint64_t &read_id) {
     auto kmer = get_kmer_from_read(parameters.kmers_size, read); // Gets last k bases of read
 
     auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info);
@@ -207,12 +310,12 @@ bool gram::quasimap_read(const Pattern &read,
         return read_mapped_exactly;
     auto read_length = read.size();
 
-    uint64_t  random_seed = parameters.seed;
+    RandomGenerator random_generator(parameters.seed, read_id);
     coverage::record::search_states(coverage,
                                     search_states,
                                     read_length,
                                     prg_info,
-                                    random_seed);
+                                    random_generator);
     return read_mapped_exactly;
 }
 
@@ -44,7 +44,7 @@ SearchStates gram::handle_allele_encapsulated_state(const SearchState &search_st
          sa_index <= search_state.sa_interval.second;
          ++sa_index) {
 
-        auto prg_index = prg_info.fm_index[sa_index];
+        auto prg_index = locate(sa_index, prg_info);
         auto site_marker = prg_info.sites_mask[prg_index];
         auto allele_id = prg_info.allele_mask[prg_index];
 
@@ -114,26 +114,25 @@ SearchStates gram::search_read_backwards(const Pattern &read,
                                          const KmerIndex &kmer_index,
                                          const PRG_Info &prg_info) {
     // Test if kmer has been indexed
-    bool kmer_in_index = kmer_index.find(kmer) != kmer_index.end();
+    auto kmer_position = kmer_index.find(kmer);
+    bool kmer_in_index = kmer_position != KmerIndex::npos;
     if (not kmer_in_index)
         return SearchStates{};
 
-    // Test if kmer has been indexed, but has no search states in prg
-    auto kmer_index_search_states = kmer_index.at(kmer);
-    if (kmer_index_search_states.empty())
-        return kmer_index_search_states;
-
-
     // Reverse iterator + skipping through indexed kmer in read
     auto read_begin = read.rbegin();
     std::advance(read_begin, kmer.size());
 
-    SearchStates new_search_states = kmer_index_search_states;
+    SearchStates new_search_states = kmer_index.search_states(kmer_position);
+    // Test if kmer has been indexed, but has no search states in prg
+    if (new_search_states.empty())
+        return new_search_states;
 
     for (auto it = read_begin; it != read.rend(); ++it) { /// Iterates end to start of read
         const Base &pattern_char = *it;
+        // The search states are extended in place: they are not needed once the next ones are computed.
         new_search_states = process_read_char_search_states(pattern_char,
-                                                            new_search_states,
+                                                            std::move(new_search_states),
                                                             prg_info);
         // Test if no mapping found upon character extension
         auto read_not_mapped = new_search_states.empty();
@@ -146,43 +145,26 @@ SearchStates gram::search_read_backwards(const Pattern &read,
 }
 
 
-/**
- * Backward search followed by check whether the extended searched pattern maps somewhere in the prg.
- */
-SearchState search_fm_index_base_backwards(const Base &pattern_char,
-                                           const uint64_t char_first_sa_index,
-                                           const SearchState &search_state,
-                                           const PRG_Info &prg_info) {
-    auto next_sa_interval = base_next_sa_interval(pattern_char,
-                                                  char_first_sa_index,
-                                                  search_state.sa_interval,
-                                                  prg_info);
-    //  An 'invalid' SA interval (i,j) is defined by i-1=j, which occurs when the read no longer maps anywhere in the prg.
-    auto valid_sa_interval = next_sa_interval.first - 1 != next_sa_interval.second;
-    if (not valid_sa_interval) { // Create an empty, invalid search state.
-        SearchState new_search_state;
-        new_search_state.invalid = true;
-        return new_search_state;
-    }
-
-    auto new_search_state = search_state;
-    new_search_state.sa_interval.first = next_sa_interval.first;
-    new_search_state.sa_interval.second = next_sa_interval.second;
-    return new_search_state;
+SearchStates gram::process_read_char_search_states(const Base &pattern_char,
+                                                   const SearchStates &old_search_states,
+                                                   const PRG_Info &prg_info) {
+    SearchStates search_states = old_search_states;
+    return process_read_char_search_states(pattern_char,
+                                           std::move(search_states),
+                                           prg_info);
 }
 
 SearchStates gram::process_read_char_search_states(const Base &pattern_char,
-                                                   const SearchStates &old_search_states,
+                                                   SearchStates &&old_search_states,
                                                    const PRG_Info &prg_info) {
     //  Before extending backward search with next character, check for variant markers in the current SA intervals
     //  This is the v part of vBWT.
-    auto post_markers_search_states = process_markers_search_states(old_search_states,
+    auto post_markers_search_states = process_markers_search_states(std::move(old_search_states),
                                                                     prg_info);
     //  Regular backward searching
-    auto new_search_states = search_base_backwards(pattern_char,
-                                                   post_markers_search_states,
-                                                   prg_info);
-    return new_search_states;
+    return search_base_backwards(pattern_char,
+                                 std::move(post_markers_search_states),
+                                 prg_info);
 }
 
 
@@ -192,30 +174,13 @@ SA_Interval gram::base_next_sa_interval(const Marker &next_char,
                                         const PRG_Info &prg_info) {
     const auto &current_sa_start = current_sa_interval.first;
     const auto &current_sa_end = current_sa_interval.second;
+    // Markers are never searched for: they are found by `left_markers_search`.
+    assert(next_char >= 1 and next_char <= 4);
 
-    SA_Index sa_start_offset;
-    if (current_sa_start <= 0)
-        sa_start_offset = 0;
-    else {
-        //  TODO: Consider deleting this if-clause, next_char should never be > 4, it probably never runs
-        if (next_char > 4)
-            sa_start_offset = prg_info.fm_index.bwt.rank(current_sa_start, next_char);
-        else {
-            sa_start_offset = dna_bwt_rank(current_sa_start,
-                                           next_char,
-                                           prg_info);
-        }
-    }
-
-    SA_Index sa_end_offset;
-    //  TODO: Consider deleting this if-clause, next_char should never be > 4, it probably never runs
-    if (next_char > 4)
-        sa_end_offset = prg_info.fm_index.bwt.rank(current_sa_end + 1, next_char);
-    else {
-        sa_end_offset = dna_bwt_rank(current_sa_end + 1,
-                                     next_char,
-                                     prg_info);
-    }
+    // Each rank query reads a single (interleaved) block of the DNA occurrence table.
+    const auto &dna_bwt_occ = prg_info.dna_bwt_occ;
+    SA_Index sa_start_offset = dna_bwt_occ.rank(current_sa_start, (Base) next_char);
+    SA_Index sa_end_offset = dna_bwt_occ.rank(current_sa_end + 1, (Base) next_char);
 
     auto new_start = next_char_first_sa_index + sa_start_offset;
     auto new_end = next_char_first_sa_index + sa_end_offset - 1;
@@ -225,38 +190,60 @@ SA_Interval gram::base_next_sa_interval(const Marker &next_char,
 SearchStates gram::search_base_backwards(const Base &pattern_char,
                                          const SearchStates &search_states,
                                          const PRG_Info &prg_info) {
-    // Compute the first occurrence of `pattern_char` in the suffix array. Necessary for backward search.
-    auto char_alphabet_rank = prg_info.fm_index.char2comp[pattern_char];
-    auto char_first_sa_index = prg_info.fm_index.C[char_alphabet_rank];
-
-    SearchStates new_search_states = {};
+    SearchStates new_search_states = search_states;
+    return search_base_backwards(pattern_char,
+                                 std::move(new_search_states),
+                                 prg_info);
+}
 
-    for (const auto &search_state: search_states) {
-        SearchState new_search_state = search_fm_index_base_backwards(pattern_char,
-                                                                      char_first_sa_index,
-                                                                      search_state,
-                                                                      prg_info);
-        if (new_search_state.invalid)
+SearchStates gram::search_base_backwards(const Base &pattern_char,
+                                         SearchStates &&search_states,
+                                         const PRG_Info &prg_info) {
+    // Compute the first occurrence of `pattern_char` in the suffix array. Necessary for backward search.
+    SA_Index char_first_sa_index = prg_info.dna_first_sa_indexes[pattern_char];
+
+    // Search states are updated in place; those which no longer map are overwritten by the next valid ones.
+    auto valid_end = search_states.begin();
+    for (auto &search_state: search_states) {
+        auto next_sa_interval = base_next_sa_interval(pattern_char,
+                                                      char_first_sa_index,
+                                                      search_state.sa_interval,
+                                                      prg_info);
+        //  An 'invalid' SA interval (i,j) is defined by i-1=j, which occurs when the read no longer maps anywhere in the prg.
+        auto valid_sa_interval = next_sa_interval.first - 1 != next_sa_interval.second;
+        if (not valid_sa_interval)
             continue;
-        new_search_states.emplace_back(new_search_state);
-    }
 
-    return new_search_states;
+        search_state.sa_interval = next_sa_interval;
+        if (&*valid_end != &search_state)
+            *valid_end = std::move(search_state);
+        ++valid_end;
+    }
+    search_states.erase(valid_end, search_states.end());
+    return std::move(search_states);
 }
 
 
 SearchStates gram::process_markers_search_states(const SearchStates &old_search_states,
                                                  const PRG_Info &prg_info) {
     SearchStates new_search_states = old_search_states;
+    return process_markers_search_states(std::move(new_search_states),
+                                         prg_info);
+}
+
+SearchStates gram::process_markers_search_states(SearchStates &&old_search_states,
+                                                 const PRG_Info &prg_info) {
     SearchStates all_markers_new_search_states;
     for (const auto &search_state: old_search_states) {
         auto markers_search_states = process_markers_search_state(search_state, prg_info);
-        all_markers_new_search_states.splice(all_markers_new_search_states.end(),
-                                             markers_search_states);
+        all_markers_new_search_states.insert(all_markers_new_search_states.end(),
+                                             std::make_move_iterator(markers_search_states.begin()),
+                                             std::make_move_iterator(markers_search_states.end()));
     }
-    new_search_states.splice(new_search_states.end(),
-                             all_markers_new_search_states);
-    return new_search_states;
+    old_search_states.insert(old_search_states.end(),
+                             std::make_move_iterator(all_markers_new_search_states.begin()),
+                             std::make_move_iterator(all_markers_new_search_states.end()));
+    return std::move(old_search_states);
 }
 
 
@@ -274,35 +261,10 @@ struct SiteBoundaryMarkerInfo {
 SiteBoundaryMarkerInfo site_boundary_marker_info(const Marker &marker_char,
                                                  const SA_Index &sa_right_of_marker,
                                                  const PRG_Info &prg_info) {
-
-    // char2comp -> rank of ordered alphabet set
-    auto alphabet_rank = prg_info.fm_index.char2comp[marker_char];
-    auto first_sa_index = prg_info.fm_index.C[alphabet_rank];
-
-    uint64_t marker_sa_index_offset;
-    //  TODO: how can sa_right_of_marker be 0? how can it be <0?
-    if (sa_right_of_marker <= 0)
-        marker_sa_index_offset = 0;
-    else
-        // The offset is calculated as it would be during a backward search, using BWT
-        // Note that the rank query is **non-inclusive** of arg1
-        marker_sa_index_offset = prg_info.fm_index.bwt.rank(sa_right_of_marker,
-                                                            marker_char);
-    // The marker is found by updating the SA interval as for a backward search
-    auto marker_sa_index = first_sa_index + marker_sa_index_offset;
-
-    // Get marker PRG index
-    const auto marker_text_idx = prg_info.fm_index[marker_sa_index];
-
-    // Get other site marker PRG index
-    uint64_t other_marker_text_idx;
-    if (marker_sa_index == first_sa_index)
-        other_marker_text_idx = prg_info.fm_index[first_sa_index + 1];
-    else
-        other_marker_text_idx = prg_info.fm_index[first_sa_index];
-
-    // If the marker of interest's position is lower than the other marker, the marker is at the start of the variant site.
-    const bool marker_is_boundary_start = marker_text_idx <= other_marker_text_idx;
+    const auto &site_info = site_marker_info(marker_char, prg_info);
+    // Each site marker occurs twice in the BWT: the character right of the marker tells which occurrence this is.
+    const bool marker_is_boundary_start = sa_right_of_marker == site_info.sa_right_of_start;
+    const auto marker_sa_index = marker_is_boundary_start ? site_info.start_sa_index : site_info.end_sa_index;
     return SiteBoundaryMarkerInfo{
             marker_is_boundary_start,
             SA_Interval{marker_sa_index, marker_sa_index},
@@ -315,37 +277,13 @@ SiteBoundaryMarkerInfo site_boundary_marker_info(const Marker &marker_char,
  */
 SA_Interval gram::get_allele_marker_sa_interval(const Marker &site_marker_char,
                                                 const PRG_Info &prg_info) {
-    const auto allele_marker_char = site_marker_char + 1;
-    const auto alphabet_rank = prg_info.fm_index.char2comp[allele_marker_char];
-    const auto start_sa_index = prg_info.fm_index.C[alphabet_rank];
-
-    const auto next_boundary_marker =
-            allele_marker_char + 1; // TODO: this assumes a continuous integer ordering of the site markers...
-
-    // sigma: is the size (=number of unique symbols) of the alphabet
-    const auto max_alphabet_char = prg_info.fm_index.comp2char[prg_info.fm_index.sigma - 1];
-
-    // Check the next variant site marker exists.
-    // `max_alphabet_char` is an allele marker and so cannot be equal to `next_boundary_marker` which is a site marker.
-    const bool next_boundary_marker_valid = next_boundary_marker < max_alphabet_char;
-
-    SA_Index end_sa_index;
-    if (next_boundary_marker_valid) { //  Condition: the allele marker is not the largest existing allele marker number.
-        const auto next_boundary_marker_rank =
-                prg_info.fm_index.char2comp[next_boundary_marker];
-        const auto next_boundary_marker_start_sa_index =
-                prg_info.fm_index.C[next_boundary_marker_rank];
-        end_sa_index = next_boundary_marker_start_sa_index - 1;
-    } else { // If it does not exist, the last prg position is variant site exit point.
-        end_sa_index = prg_info.fm_index.size() - 1;
-    }
-    return SA_Interval{start_sa_index, end_sa_index};
+    return site_marker_info(site_marker_char, prg_info).allele_marker_sa_interval();
 }
 
 AlleleId gram::get_allele_id(const SA_Index &allele_marker_sa_index,
                              const PRG_Info &prg_info) {
     //  What is the index of the character just before the marker allele in the original text?
-    auto internal_allele_text_index = prg_info.fm_index[allele_marker_sa_index] - 1;
+    auto internal_allele_text_index = locate(allele_marker_sa_index, prg_info) - 1;
     auto allele_id = (AlleleId) prg_info.allele_mask[internal_allele_text_index];
     assert(allele_id > 0);
     return allele_id;
@@ -408,18 +346,6 @@ SearchState get_site_search_state(const AlleleId &final_allele_id,
 }
 
 
-/**
- * Compute number of alleles in a site from the allele marker's full SA interval.
- */
-uint64_t get_number_of_alleles(const SA_Interval &allele_marker_sa_interval) {
-    auto num_allele_markers = allele_marker_sa_interval.second
-                              - allele_marker_sa_interval.first
-                              + 1;
-    // The allele marker's full SA interval does not include the variant site exit point, which also marks the last allele's end point.
-    auto num_alleles = num_allele_markers + 1;
-    return num_alleles;
-}
-
 /**
  * Deals with a read mapping into a variant site's end point.
  * The SA index of each allele's end gets added as a new SearchState.
@@ -429,18 +355,15 @@ SearchStates entering_site_search_states(const SiteBoundaryMarkerInfo &boundary_
                                          const SearchState &current_search_state,
                                          const PRG_Info &prg_info) {
     // Get full SA interval of the corresponding allele marker.
-    auto allele_marker_sa_interval =
-            get_allele_marker_sa_interval(boundary_marker_info.marker_char,
-                                          prg_info);
+    const auto &site_info = site_marker_info(boundary_marker_info.marker_char, prg_info);
     // Get one `SearchState` per allele in the site, with populated cache.
     auto new_search_states = get_allele_search_states(boundary_marker_info.marker_char,
-                                                      allele_marker_sa_interval,
+                                                      site_info.allele_marker_sa_interval(),
                                                       current_search_state,
                                                       prg_info);
 
     // One more SA interval needs to be added: that of the final allele in the site.
-    auto final_allele_id = get_number_of_alleles(
-            allele_marker_sa_interval); // Used for populating the `SearchState`'s cache.
+    auto final_allele_id = site_info.count_alleles; // Used for populating the `SearchState`'s cache.
     auto site_search_state = get_site_search_state(final_allele_id,
                                                    boundary_marker_info,
                                                    current_search_state,
@@ -488,12 +411,17 @@ MarkersSearchResults gram::left_markers_search(const SearchState &search_state,
 
     const auto &sa_interval = search_state.sa_interval;
 
-    for (int index=sa_interval.first; index<= sa_interval.second; index++) {
-        if (prg_info.bwt_markers_mask[index] == 0) continue;
-
-        auto marker = prg_info.fm_index.bwt[index];
-        auto search_result = std::make_pair(index, marker);
-        markers_search_results.emplace_back(search_result);
+    // Ranks of the markers within the interval, which are visited by select queries rather than by scanning the interval.
+    const uint64_t markers_before_interval = prg_info.bwt_markers_rank(sa_interval.first);
+    const uint64_t markers_up_to_interval_end = prg_info.bwt_markers_rank(sa_interval.second + 1);
+    if (markers_before_interval == markers_up_to_interval_end)
+        return markers_search_results;
+
+    markers_search_results.reserve(markers_up_to_interval_end - markers_before_interval);
+    for (uint64_t marker_rank = markers_before_interval + 1; marker_rank <= markers_up_to_interval_end; ++marker_rank) {
+        const uint64_t index = prg_info.bwt_markers_select(marker_rank);
+        const Marker marker = prg_info.bwt_markers[marker_rank - 1];
+        markers_search_results.emplace_back(index, marker);
     }
 
     return markers_search_results;
@@ -551,19 +479,7 @@ SearchState process_allele_marker(const Marker &allele_marker_char,
 
     //  end of allele found, skipping to variant site start boundary marker
     const Marker &boundary_marker_char = allele_marker_char - 1;
-
-    auto alphabet_rank = prg_info.fm_index.char2comp[boundary_marker_char];
-    auto first_sa_index = prg_info.fm_index.C[alphabet_rank];
-    auto second_sa_index = first_sa_index + 1; // Variant site markers are adjacent in the suffix array.
-
-    // Determine which SA index position marks the variant site entrance by comparing the prg indices.
-    SA_Index boundary_start_sa_index;
-    bool boundary_start_is_first_sa = prg_info.fm_index[first_sa_index]
-                                      < prg_info.fm_index[second_sa_index];
-    if (boundary_start_is_first_sa)
-        boundary_start_sa_index = first_sa_index;
-    else
-        boundary_start_sa_index = second_sa_index;
+    const auto boundary_start_sa_index = site_marker_info(boundary_marker_char, prg_info).start_sa_index;
 
     auto new_search_state = current_search_state;
 
@@ -573,7 +489,7 @@ SearchState process_allele_marker(const Marker &allele_marker_char,
 
         bool started_in_site = new_search_state.variant_site_path.empty();
         if (started_in_site){
-            auto internal_allele_text_index = prg_info.fm_index[sa_right_of_marker];
+            auto internal_allele_text_index = locate(sa_right_of_marker, prg_info);
             auto allele_id = (AlleleId) prg_info.allele_mask[internal_allele_text_index]; // Query the allele mask with the prg position of the character to the right of the allele marker.
             new_search_state.variant_site_path.push_front(VariantLocus{boundary_marker_char,allele_id});
         }
@@ -607,7 +523,9 @@ SearchStates gram::process_markers_search_state(const SearchState &current_searc
                                                              sa_right_of_marker,
                                                              current_search_state,
                                                              prg_info);
-            markers_search_states.splice(markers_search_states.end(), new_search_states);
+            markers_search_states.insert(markers_search_states.end(),
+                                         std::make_move_iterator(new_search_states.begin()),
+                                         std::make_move_iterator(new_search_states.end()));
         }
             // case: the marker is an allele marker. We need to exit the variant site.
         else {
@@ -0,0 +1,76 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/bounded_queue.hpp"
+
+
+using namespace gram;
+
+
+TEST(BoundedQueue, GivenPushedElementsThenClose_ElementsPoppedInOrder) {
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    int element = 0;
+    std::vector<int> result;
+    while (queue.pop(element))
+        result.push_back(element);
+    std::vector<int> expected = {1, 2};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(BoundedQueue, GivenClosedEmptyQueue_PopReturnsFalse) {
+    BoundedQueue<int> queue(1);
+    queue.close();
+
+    int element = 7;
+    EXPECT_FALSE(queue.pop(element));
+    EXPECT_EQ(element, 7);
+}
+
+
+TEST(BoundedQueue, GivenProducerPushingMoreThanCapacity_ConsumerReceivesAllInOrder) {
+    BoundedQueue<std::vector<int>> queue(2);
+    std::thread producer([&queue]() {
+        for (int i = 0; i < 1000; ++i)
+            queue.push(std::vector<int>{i, i});
+        queue.close();
+    });
+
+    std::vector<int> element;
+    int count = 0;
+    bool in_order = true;
+    while (queue.pop(element)) {
+        in_order = in_order and element == std::vector<int>{count, count};
+        ++count;
+    }
+    producer.join();
+    EXPECT_EQ(count, 1000);
+    EXPECT_TRUE(in_order);
+}
+
+
+TEST(BoundedQueue, GivenProducerBlockedOnFullQueue_CloseReleasesProducer) {
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+    bool pushed = true;
+    std::thread producer([&]() {
+        pushed = queue.push(2);
+    });
+
+    queue.close();
+    producer.join();
+    EXPECT_FALSE(pushed);
+
+    int element = 0;
+    std::vector<int> result;
+    while (queue.pop(element))
+        result.push_back(element);
+    std::vector<int> expected = {1};
+    EXPECT_EQ(result, expected);
+}
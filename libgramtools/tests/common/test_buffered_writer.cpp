@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <zlib.h>
+
+#include "gtest/gtest.h"
+
+#include "common/buffered_writer.hpp"
+
+
+using namespace gram;
+
+
+std::string read_gzip_file(const std::string &fpath) {
+    gzFile file = gzopen(fpath.c_str(), "rb");
+    std::string content;
+    char chunk[4096];
+    int count_read;
+    while ((count_read = gzread(file, chunk, sizeof(chunk))) > 0)
+        content.append(chunk, (size_t) count_read);
+    gzclose(file);
+    return content;
+}
+
+
+TEST(BufferedWriter, GivenIntegersAndText_FormattedAsDecimal) {
+    std::string result;
+    {
+        BufferedWriter writer(result);
+        writer << '[' << (uint16_t) 65535 << ',' << (int64_t) -42 << ',' << UINT64_MAX << "]";
+    }
+    std::string expected = "[65535,-42,18446744073709551615]";
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(BufferedWriter, GivenOutputLargerThanBuffer_AllOutputWritten) {
+    std::string result;
+    std::stringstream expected;
+    {
+        BufferedWriter writer(result);
+        for (uint64_t i = 0; i < 500000; ++i) {
+            writer << i << ',';
+            expected << i << ',';
+        }
+        writer << std::string(3 << 20, 'a');
+        expected << std::string(3 << 20, 'a');
+    }
+    EXPECT_EQ(result, expected.str());
+}
+
+
+TEST(BufferedWriter, GivenFile_ContentWrittenOnDestruction) {
+    const std::string fpath = "@test_buffered_writer_plain";
+    {
+        BufferedWriter writer(fpath, OutputCompression::none);
+        writer << "coverage " << 12 << '\n';
+    }
+    std::ifstream file(fpath);
+    std::string result((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string expected = "coverage 12\n";
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(BufferedWriter, GivenGzipCompression_DecompressedContentMatches) {
+    const std::string fpath = compressed_fpath("@test_buffered_writer", OutputCompression::gzip);
+    EXPECT_EQ(fpath, "@test_buffered_writer.gz");
+    {
+        BufferedWriter writer(fpath, OutputCompression::gzip);
+        writer << "{\"allele_base_counts\":[[" << 1 << ',' << 2 << "]]}";
+    }
+    auto result = read_gzip_file(fpath);
+    std::string expected = R"({"allele_base_counts":[[1,2]]})";
+    EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,98 @@
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "gtest/gtest.h"
+
+#include "sequence_read/seqread.hpp"
+#include "common/decompression.hpp"
+
+
+using namespace gram;
+
+
+void write_gzip_file(const std::string &fpath, const std::string &content) {
+    gzFile file = gzopen(fpath.c_str(), "wb");
+    gzwrite(file, content.data(), (unsigned) content.size());
+    gzclose(file);
+}
+
+
+std::string read_to_end(const int descriptor) {
+    std::string content;
+    char chunk[4096];
+    ssize_t count_read;
+    while ((count_read = read(descriptor, chunk, sizeof(chunk))) > 0)
+        content.append(chunk, (size_t) count_read);
+    close(descriptor);
+    return content;
+}
+
+
+TEST(DetectCompressionFormat, GivenPlainFastq_NoCompression) {
+    std::string fpath = "@test_decompression_plain.fq";
+    std::ofstream(fpath) << "@read\nACGT\n+\nIIII\n";
+
+    auto result = detect_compression_format(fpath);
+    EXPECT_EQ(result, CompressionFormat::none);
+    std::remove(fpath.c_str());
+}
+
+
+TEST(DetectCompressionFormat, GivenGzipFastq_Gzip) {
+    std::string fpath = "@test_decompression_gzip.fq.gz";
+    write_gzip_file(fpath, "@read\nACGT\n+\nIIII\n");
+
+    auto result = detect_compression_format(fpath);
+    EXPECT_EQ(result, CompressionFormat::gzip);
+    std::remove(fpath.c_str());
+}
+
+
+TEST(DetectCompressionFormat, GivenBgzfEndOfFileBlock_Bgzf) {
+    std::string fpath = "@test_decompression_empty.fq.gz";
+    const unsigned char bgzf_eof_block[28] = {0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+                                              0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00,
+                                              0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    std::ofstream(fpath, std::ios::binary).write((const char *) bgzf_eof_block, sizeof(bgzf_eof_block));
+
+    auto result = detect_compression_format(fpath);
+    EXPECT_EQ(result, CompressionFormat::bgzf);
+
+    DecompressionPipe decompression_pipe(fpath, result, 2);
+    EXPECT_EQ(read_to_end(decompression_pipe.release_read_descriptor()), "");
+    std::remove(fpath.c_str());
+}
+
+
+TEST(DecompressionPipe, GivenGzipFile_DecompressedContentRead) {
+    std::string fpath = "@test_decompression_pipe.fq.gz";
+    std::string content;
+    for (int i = 0; i < 100000; ++i)
+        content += "@read" + std::to_string(i) + "\nACGTACGT\n+\nIIIIIIII\n";
+    write_gzip_file(fpath, content);
+
+    DecompressionPipe decompression_pipe(fpath, CompressionFormat::gzip, 1);
+    auto result = read_to_end(decompression_pipe.release_read_descriptor());
+    EXPECT_EQ(result, content);
+    std::remove(fpath.c_str());
+}
+
+
+TEST(DecompressionPipe, GivenGzipFastqParsedFromPipe_AllReadsParsed) {
+    std::string fpath = "@test_decompression_reads.fq.gz";
+    write_gzip_file(fpath, "@read1\nACGT\n+\nIIII\n@read2\nGGCC\n+\nIIII\n");
+
+    std::vector<std::string> result;
+    {
+        DecompressionPipe decompression_pipe(fpath, CompressionFormat::gzip, 1);
+        SeqRead reads(decompression_pipe.release_read_descriptor());
+        for (auto it = reads.begin(); it != reads.end(); ++it)
+            result.emplace_back((*it)->seq);
+    }
+    std::vector<std::string> expected = {"ACGT", "GGCC"};
+    EXPECT_EQ(result, expected);
+    std::remove(fpath.c_str());
+}
@@ -0,0 +1,92 @@
+#include <cmath>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "common/read_stats.hpp"
+
+
+using namespace gram;
+
+
+GenomicRead make_genomic_read(std::string &sequence, std::string &qualities) {
+    GenomicRead read;
+    read.seq = &sequence[0];
+    read.qual = &qualities[0];
+    return read;
+}
+
+
+TEST(ReadStats, GivenReadsWithAndWithoutQualities_QualitiesOfAllReadsRecorded) {
+    std::string first_sequence = "ACGT";
+    std::string first_qualities = "++++"; // Phred 10
+    std::string second_sequence = "ACGTAC";
+    std::string second_qualities = "";
+
+    ReadStats readstats;
+    readstats.record_read(make_genomic_read(first_sequence, first_qualities));
+    readstats.record_read(make_genomic_read(second_sequence, second_qualities));
+    readstats.compute_base_error_rate();
+
+    EXPECT_EQ(readstats.get_max_read_length(), 6);
+    EXPECT_EQ(readstats.get_num_bases_processed(), 4);
+    EXPECT_EQ(readstats.get_no_qual_reads(), 1);
+    EXPECT_DOUBLE_EQ(readstats.get_mean_error(), 0.1);
+}
+
+
+TEST(ReadStats, GivenReadsRecordedSeparately_AddedStatsSameAsRecordedTogether) {
+    std::string first_sequence = "ACGT";
+    std::string first_qualities = "5555"; // Phred 20
+    std::string second_sequence = "AC";
+    std::string second_qualities = "++"; // Phred 10
+
+    ReadStats together;
+    together.record_read(make_genomic_read(first_sequence, first_qualities));
+    together.record_read(make_genomic_read(second_sequence, second_qualities));
+    together.compute_base_error_rate();
+
+    ReadStats first, second;
+    first.record_read(make_genomic_read(first_sequence, first_qualities));
+    second.record_read(make_genomic_read(second_sequence, second_qualities));
+    first.add_read_stats(second);
+    first.compute_base_error_rate();
+
+    EXPECT_EQ(first.get_max_read_length(), together.get_max_read_length());
+    EXPECT_EQ(first.get_num_bases_processed(), 6);
+    EXPECT_DOUBLE_EQ(first.get_mean_error(), together.get_mean_error());
+}
+
+
+TEST(ReadStats, GivenGroupedAlleleCounts_CorrectDepthMeanAndVariance) {
+    Coverage coverage = {};
+    coverage.grouped_allele_counts = {
+            GroupedAlleleCounts {
+                    {AlleleIds {0}, 3},
+                    {AlleleIds {0, 1}, 1},
+            },
+            GroupedAlleleCounts {},
+            GroupedAlleleCounts {
+                    {AlleleIds {1}, 2},
+            },
+    };
+
+    ReadStats readstats;
+    readstats.compute_coverage_depth(coverage);
+
+    EXPECT_DOUBLE_EQ(readstats.get_mean_depth(), 2);
+    EXPECT_DOUBLE_EQ(readstats.get_variance_depth(), 8.0 / 3);
+    EXPECT_EQ(readstats.get_num_sites_noCov(), 1);
+}
+
+
+TEST(ReadStats, GivenSitesOfEqualLargeDepth_ZeroVariance) {
+    Coverage coverage = {};
+    coverage.grouped_allele_counts.assign(1000, GroupedAlleleCounts {{AlleleIds {0}, 100000001}});
+
+    ReadStats readstats;
+    readstats.compute_coverage_depth(coverage);
+
+    EXPECT_DOUBLE_EQ(readstats.get_mean_depth(), 100000001);
+    EXPECT_EQ(readstats.get_variance_depth(), 0);
+}
@@ -1,4 +1,5 @@
 #include <cctype>
+#include <omp.h>
 
 #include "gtest/gtest.h"
 
@@ -336,7 +337,7 @@ TEST(IndexKmers, KmerFromAlleleCenter_KmerEntryFoundNoVariantSitePath) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto found = kmer_index.find(first_full_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(first_full_kmer);
     EXPECT_TRUE(found);
 
     auto search_states = kmer_index[first_full_kmer];
@@ -521,7 +522,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerEndingAtTailExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {4, 3, 3, 1, 1, 2, 3, 3, 2, 4, 2, 3, 2, 3, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -541,7 +542,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerStartingAtLeftMostAlleleChar
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 4, 2, 2, 2, 2, 3, 1, 2, 3, 1, 4, 4, 2, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -561,7 +562,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerImmediatelyAfterSiteExtracte
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {4, 2, 2, 2, 2, 3, 1, 2, 3, 1, 4, 4, 2, 2, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -582,7 +583,7 @@ TEST(IndexKmers, KmerStartsOneBaseBeyondRangeEdge_KmerNotExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {3, 1, 2, 3, 1, 4, 4, 2, 2, 2, 2, 3, 1, 2, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_FALSE(found);
 }
 
@@ -603,7 +604,7 @@ TEST(IndexKmers, KmerStartsAtRangeEdge_KmerExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {3, 1, 2, 3, 1, 4, 4, 2, 2, 2, 2, 3, 1, 2, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -623,7 +624,7 @@ TEST(IndexKmers, KmerWithinMaxReadSizeRegionNoSiteOverlap_KmerFound) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 2, 1, 3, 1, 2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -643,7 +644,7 @@ TEST(IndexKmers, KmerEndJustOutsideMaxReadSize_KmerNotFoundInIndex) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 2, 1, 3, 1, 2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_FALSE(found);
 }
 
@@ -663,7 +664,7 @@ TEST(IndexKmers, TwoSitesAndKmerWithinMaxReadSizeRegionNoSiteOverlap_KmerFound)
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {2, 3, 1, 4, 4};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_TRUE(found);
 }
 
@@ -683,7 +684,7 @@ TEST(IndexKmers, TwoSitesAndKmerOutsideMaxReadSizeRegionNoSiteOverlap_KmerNotFou
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.contains(target_kmer);
     EXPECT_FALSE(found);
 }
 
@@ -707,3 +708,67 @@ TEST(IndexKmers, GivenTwoSerializedKmers_CorrectlyExtrctedKmers) {
     };
     EXPECT_EQ(result, expected);
 }
+
+
+TEST(GetKmerPartitions, GivenPrefixDiffLengths_PartitionsStartAtFullKmers) {
+    std::vector<uint8_t> prefix_diff_lengths = {3, 1, 2, 3, 1, 3, 2};
+
+    auto result = get_kmer_partitions(prefix_diff_lengths, 3, 3);
+    std::vector<KmerPartition> expected = {
+            {0, 3},
+            {3, 5},
+            {5, 7},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GetKmerPartitions, GivenNoFullKmerAfterFirst_SinglePartition) {
+    std::vector<uint8_t> prefix_diff_lengths = {3, 1, 2};
+
+    auto result = get_kmer_partitions(prefix_diff_lengths, 3, 8);
+    std::vector<KmerPartition> expected = {
+            {0, 3},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(IndexKmers, GivenSeveralThreads_SameKmerIndexAsSingleThread) {
+    auto prg_raw = "atggaacggct25cg26cc26tg26tc25cg27g28a27tccccgacgattccccgacgattccccgacgattccccgacgattccccgacgattccccgacgat";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Parameters parameters = {};
+    parameters.kmers_size = 5;
+    parameters.max_read_size = 20;
+    auto kmer_prefix_diffs = get_all_kmer_and_compute_prefix_diffs(parameters,
+                                                                   prg_info);
+
+    const auto max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    auto expected = index_kmers(kmer_prefix_diffs, parameters.kmers_size, prg_info);
+    omp_set_num_threads(4);
+    auto result = index_kmers(kmer_prefix_diffs, parameters.kmers_size, prg_info);
+    omp_set_num_threads(max_threads);
+
+    EXPECT_EQ(result, expected);
+    EXPECT_FALSE(result.empty());
+}
+
+
+TEST(IndexKmers, GivenPackedReverseKmers_SameKmerIndexAsPrefixDiffs) {
+    auto prg_raw = "atggaacggct25cg26cc26tg26tc25cg27g28a27tccccgacgattccccgacgat";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Parameters parameters = {};
+    parameters.kmers_size = 5;
+    parameters.max_read_size = 20;
+    auto kmer_prefix_diffs = get_all_kmer_and_compute_prefix_diffs(parameters,
+                                                                   prg_info);
+    auto expected = index_kmers(kmer_prefix_diffs, parameters.kmers_size, prg_info);
+
+    auto reverse_kmers = get_all_reverse_kmers(parameters, prg_info);
+    auto result = index_kmers(reverse_kmers, parameters.kmers_size, prg_info);
+    EXPECT_EQ(result, expected);
+    EXPECT_FALSE(result.empty());
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "kmer_index/kmer_index_types.hpp"
+
+
+using namespace gram;
+
+
+TEST(PackKmer, GivenKmer_FirstBaseMostSignificant) {
+    Pattern kmer = {1, 2, 3, 4};
+    auto result = pack_kmer(kmer);
+    PackedKmer expected = 0b00011011;
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(PackKmer, GivenMaximumSizeKmer_UnpackedKmerUnchanged) {
+    Pattern kmer(max_packed_kmer_size, 4);
+    kmer.front() = 2;
+    kmer.back() = 1;
+    auto result = unpack_kmer(pack_kmer(kmer), max_packed_kmer_size);
+    EXPECT_EQ(result, kmer);
+}
+
+
+TEST(KmerIndex, GivenUnsortedEntries_KmersSortedWithOffsetsFollowing) {
+    KmerIndex kmer_index = {
+            {{4, 4}, SearchStates {
+                    SearchState {SA_Interval {7, 8}, VariantSitePath {VariantLocus {5, 1}, VariantLocus {7, 2}}}
+            }},
+            {{1, 2}, SearchStates {
+                    SearchState {SA_Interval {1, 1}},
+                    SearchState {SA_Interval {2, 3}, VariantSitePath {VariantLocus {9, 1}}}
+            }},
+    };
+
+    EXPECT_EQ(kmer_index.kmers, (std::vector<PackedKmer> {pack_kmer({1, 2}), pack_kmer({4, 4})}));
+    EXPECT_EQ(kmer_index.search_states_offsets, (std::vector<uint64_t> {0, 2, 3}));
+    EXPECT_EQ(kmer_index.paths_offsets, (std::vector<uint64_t> {0, 0, 1, 3}));
+    EXPECT_EQ(kmer_index.paths, (std::vector<VariantLocus> {VariantLocus {9, 1}, VariantLocus {5, 1}, VariantLocus {7, 2}}));
+}
+
+
+TEST(KmerIndex, GivenIndexedKmer_SearchStatesRebuilt) {
+    SearchStates search_states = {
+            SearchState {
+                    SA_Interval {2, 3},
+                    VariantSitePath {VariantLocus {9, 1}},
+                    SearchVariantSiteState::within_variant_site
+            }
+    };
+    KmerIndex kmer_index = {
+            {{3, 1, 2}, search_states},
+            {{1, 1, 1}, SearchStates {SearchState {SA_Interval {1, 1}}}},
+    };
+
+    auto result = kmer_index[{3, 1, 2}];
+    EXPECT_EQ(result, search_states);
+}
+
+
+TEST(KmerIndex, GivenAbsentKmer_NotFoundAndNotInserted) {
+    KmerIndex kmer_index = {
+            {{1, 1, 1}, SearchStates {SearchState {SA_Interval {1, 1}}}},
+    };
+
+    EXPECT_FALSE(kmer_index.contains({1, 1, 2}));
+    EXPECT_FALSE(kmer_index.contains({1, 1}));
+    EXPECT_TRUE((kmer_index[{1, 1, 2}].empty()));
+    EXPECT_EQ(kmer_index.size(), 1);
+}
+
+
+TEST(KmerIndex, GivenDirectLookup_SameKmerPositionsAsBinarySearch) {
+    KmerIndex kmer_index = {
+            {{4, 1, 3}, SearchStates {SearchState {SA_Interval {3, 4}}}},
+            {{1, 1, 1}, SearchStates {SearchState {SA_Interval {1, 1}}}},
+            {{2, 4, 4}, SearchStates {SearchState {SA_Interval {2, 2}}}},
+    };
+    std::vector<uint64_t> expected;
+    for (PackedKmer packed_kmer = 0; packed_kmer < 64; ++packed_kmer)
+        expected.push_back(kmer_index.find(packed_kmer));
+
+    kmer_index.build_direct_lookup();
+    std::vector<uint64_t> result;
+    for (PackedKmer packed_kmer = 0; packed_kmer < 64; ++packed_kmer)
+        result.push_back(kmer_index.find(packed_kmer));
+
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(kmer_index.find({4, 1, 3}), 2);
+}
+
+
+TEST(UseDirectLookup, GivenSmallKmerSizeAndLargePrg_DirectLookupUsed) {
+    EXPECT_TRUE(use_direct_lookup(11, 2000000));
+    EXPECT_FALSE(use_direct_lookup(11, 100));
+    EXPECT_FALSE(use_direct_lookup(max_direct_lookup_kmer_size + 1, UINT32_MAX));
+}
@@ -839,6 +839,41 @@ TEST(GetRegionPartsReverseKmers, SingleRegionWithSingleCharAllele_NoReverseKmer)
 }
 
 
+TEST(GetRegionPartsReverseKmers, GivenEmptyAllele_KmersSkipAndSpanIt) {
+    std::list<Patterns> region_parts = {
+            {{1}, {2}},
+            {{3}},
+            {{4}, {}},
+            {{1}},
+    };
+    uint64_t kmer_size = 3;
+
+    auto result = get_region_parts_reverse_kmers(region_parts, kmer_size);
+    unordered_vector_set<Pattern> expected = {
+            {4, 3, 1},
+            {4, 3, 2},
+            {1, 4, 3},
+            {1, 3, 1},
+            {1, 3, 2},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GetRegionPartsReverseKmers, GivenManyAdjacentSnps_AllKmersWithoutEnumeratingPaths) {
+    // 2^60 paths, but only 2^3 distinct kmers.
+    std::list<Patterns> region_parts(60, Patterns{{1}, {2}});
+    uint64_t kmer_size = 3;
+
+    auto result = get_region_parts_reverse_kmers(region_parts, kmer_size);
+    unordered_vector_set<Pattern> expected = {
+            {1, 1, 1}, {1, 1, 2}, {1, 2, 1}, {1, 2, 2},
+            {2, 1, 1}, {2, 1, 2}, {2, 2, 1}, {2, 2, 2},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
 TEST(GetPathReverseKmers, GivenPath_CorrectReverseKmers) {
     Pattern path = {3, 3, 1, 2};
     uint64_t kmer_size = 3;
@@ -1182,11 +1217,11 @@ TEST(CombineOverlappingRegions, EmptyRange_EmptyRange) {
 }
 
 
-TEST(GetReversedKmers, GivenRandomlyArrangedReverseKmers_KmersReversedAndSortedByRightMostBase) {
-    ordered_vector_set<Pattern> kmers = {
-            {2, 4, 1},
-            {1, 3, 5},
+TEST(GetReversedKmers, GivenSortedReverseKmers_KmersReversedAndSortedByRightMostBase) {
+    Patterns kmers = {
             {1, 3, 4},
+            {1, 3, 5},
+            {2, 4, 1},
             {3, 4, 5},
     };
 
@@ -1202,7 +1237,7 @@ TEST(GetReversedKmers, GivenRandomlyArrangedReverseKmers_KmersReversedAndSortedB
 
 
 TEST(GetReversedKmers, GivenSingleReverseKmer_CorrectReversedKmer) {
-    ordered_vector_set<Pattern> kmers = {
+    Patterns kmers = {
             {2, 4, 1},
     };
 
@@ -1215,7 +1250,7 @@ TEST(GetReversedKmers, GivenSingleReverseKmer_CorrectReversedKmer) {
 
 
 TEST(GetReversedKmers, SortingReverseKmerFromRightToLeft_CorrectReversedKmers) {
-    ordered_vector_set<Pattern> kmers = {
+    Patterns kmers = {
             {1, 3, 5},
             {2, 4, 1},
     };
@@ -1294,8 +1329,8 @@ TEST(GetAllReverseKmers, GivenOverkillMaxReadSize_AllPossibleKmersReturned) {
     parameters.kmers_size = 3;
     parameters.max_read_size = 10;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected = {
             {3, 1, 4},
             {1, 1, 4},
@@ -1306,7 +1341,7 @@ TEST(GetAllReverseKmers, GivenOverkillMaxReadSize_AllPossibleKmersReturned) {
             {2, 1, 1},
             {2, 1, 3},
     };
-    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, Patterns(expected.begin(), expected.end()));
 }
 
 
@@ -1318,8 +1353,8 @@ TEST(GetAllReverseKmers, KmerPossibleAfterVariantSite_ReverseKmerIncludedInResul
     parameters.kmers_size = 3;
     parameters.max_read_size = 10;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected = {
             {3, 1, 4},
             {1, 1, 4},
@@ -1331,7 +1366,7 @@ TEST(GetAllReverseKmers, KmerPossibleAfterVariantSite_ReverseKmerIncludedInResul
             {2, 1, 3},
             {1, 4, 2},
     };
-    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, Patterns(expected.begin(), expected.end()));
 }
 
 
@@ -1343,8 +1378,8 @@ TEST(GetAllReverseKmers, SecondVariantSiteEndsAtPrgEnd_CorrectReverseKmers) {
     parameters.kmers_size = 3;
     parameters.max_read_size = 10;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected = {
             {3, 1, 4},
             {1, 1, 4},
@@ -1359,7 +1394,7 @@ TEST(GetAllReverseKmers, SecondVariantSiteEndsAtPrgEnd_CorrectReverseKmers) {
             {2, 2, 4},
             {4, 4, 3},
     };
-    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, Patterns(expected.begin(), expected.end()));
 }
 
 /**
@@ -1374,8 +1409,8 @@ TEST(GetAllReverseKmers, KmersOverlappingTwoVariantSites_CorrectReverseKmers) {
     parameters.kmers_size = 5;
     parameters.max_read_size = 10;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected = {
             {4, 4, 3, 2, 1},
             {4, 4, 3, 2, 3},
@@ -1389,7 +1424,7 @@ TEST(GetAllReverseKmers, KmersOverlappingTwoVariantSites_CorrectReverseKmers) {
             {2, 1, 1, 4, 2},
             {2, 3, 1, 4, 2},
     };
-    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, Patterns(expected.begin(), expected.end()));
 }
 
 
@@ -1401,14 +1436,14 @@ TEST(GetAllReverseKmers, TwoLeftMostKmersWithinRange_TwoLeftMostKmersIncluded) {
     parameters.kmers_size = 3;
     parameters.max_read_size = 3;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected_absent = {
             {4, 3, 2},
             {3, 2, 1},
     };
     for (const auto &reverse_kmer: expected_absent) {
-        auto found_flag = result.find(reverse_kmer) != result.end();
+        auto found_flag = std::find(result.begin(), result.end(), reverse_kmer) != result.end();
         EXPECT_TRUE(found_flag);
     }
 }
@@ -1422,8 +1457,8 @@ TEST(GetAllReverseKmers, MaxReadSizeLessThanKmerSize_AlleleKmersReturned) {
     parameters.kmers_size = 3;
     parameters.max_read_size = 1;
 
-    auto result = get_prg_reverse_kmers(parameters,
-                                        prg_info);
+    auto result = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     ordered_vector_set<Pattern> expected = {
             {1, 1, 1},
             {1, 1, 4},
@@ -1435,7 +1470,7 @@ TEST(GetAllReverseKmers, MaxReadSizeLessThanKmerSize_AlleleKmersReturned) {
             {3, 2, 1},
             {4, 3, 2},
     };
-    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, Patterns(expected.begin(), expected.end()));
 }
 
 
@@ -1448,10 +1483,10 @@ TEST(GetAllReverseKmers, GivenPrg_CorrectReverseKmerFound) {
     parameters.kmers_size = 15;
     parameters.max_read_size = 150;
 
-    auto reverse_kmers = get_prg_reverse_kmers(parameters,
-                                               prg_info);
+    auto reverse_kmers = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     Pattern expected_reverse_kmer = {3, 3, 2, 3, 2, 4, 2, 3, 3, 2, 1, 1, 3, 3, 4};
-    auto result = reverse_kmers.find(expected_reverse_kmer) != reverse_kmers.end();
+    auto result = std::find(reverse_kmers.begin(), reverse_kmers.end(), expected_reverse_kmer) != reverse_kmers.end();
     EXPECT_TRUE(result);
 }
 
@@ -1465,10 +1500,10 @@ TEST(GetAllReverseKmers, GivenPrgWithLongNonVariantTail_PreviouslyAbsentKmerFoun
     parameters.kmers_size = 15;
     parameters.max_read_size = 20;
 
-    auto kmers = get_prg_reverse_kmers(parameters,
-                                       prg_info);
+    auto kmers = unpack_kmers(get_prg_reverse_kmers(parameters, prg_info),
+                               parameters.kmers_size);
     Pattern expected_kmer = {3, 3, 2, 3, 2, 4, 2, 3, 3, 2, 1, 1, 3, 3, 4};
-    auto result = kmers.find(expected_kmer) != kmers.end();
+    auto result = std::find(kmers.begin(), kmers.end(), expected_kmer) != kmers.end();
     EXPECT_TRUE(result);
 }
 
@@ -1518,6 +1553,7 @@ TEST(GetAllKmers, GenerateAllKmersLengthThree_CorrectOrder) {
     auto prg_info = generate_prg_info(prg_raw);
     Parameters parameters = {};
     parameters.kmers_size = 3;
+    parameters.all_kmers_flag = true;
 
     auto result = get_all_kmers(parameters,
                                prg_info);
@@ -1620,3 +1656,66 @@ TEST(GenerateKmers, GenerateAllKmersOfSizeThree_CorrectSpotCheck) {
         EXPECT_TRUE(result);
     }
 }
+
+
+TEST(SortPackedKmers, GivenUnsortedKmersWithRepeats_SortedWithoutDuplicates) {
+    Patterns kmers = {
+            {4, 4, 4},
+            {1, 1, 2},
+            {2, 3, 4},
+            {1, 1, 1},
+            {2, 3, 4},
+            {1, 1, 2},
+    };
+    PackedKmers packed_kmers;
+    for (const auto &kmer: kmers)
+        packed_kmers.push_back(pack_kmer(kmer));
+
+    sort_packed_kmers(packed_kmers, 3);
+    auto result = unpack_kmers(packed_kmers, 3);
+    Patterns expected = {
+            {1, 1, 1},
+            {1, 1, 2},
+            {2, 3, 4},
+            {4, 4, 4},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(SortPackedKmers, GivenKmersLongerThanOneDigit_SameOrderAsSort) {
+    PackedKmers packed_kmers;
+    PackedKmer packed_kmer = 12345;
+    for (int i = 0; i < 1000; ++i) {
+        packed_kmer = (packed_kmer * 6364136223846793005 + 1442695040888963407) & (((PackedKmer) 1 << 22) - 1);
+        packed_kmers.push_back(packed_kmer);
+    }
+    auto expected = packed_kmers;
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+    sort_packed_kmers(packed_kmers, 11);
+    EXPECT_EQ(packed_kmers, expected);
+}
+
+
+TEST(GetPrefixDiffLengths, GivenSortedReverseKmers_SameLengthsAsPrefixDiffs) {
+    Patterns reverse_kmers = {
+            {1, 1, 1},
+            {1, 1, 2},
+            {1, 3, 2},
+            {3, 3, 2},
+            {4, 1, 1},
+    };
+    PackedKmers packed_reverse_kmers;
+    for (const auto &reverse_kmer: reverse_kmers)
+        packed_reverse_kmers.push_back(pack_kmer(reverse_kmer));
+
+    auto result = get_prefix_diff_lengths(packed_reverse_kmers, 3);
+    auto prefix_diffs = get_prefix_diffs(reverse(reverse_kmers));
+    std::vector<uint8_t> expected;
+    for (const auto &prefix_diff: prefix_diffs)
+        expected.push_back(prefix_diff.size());
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(result, (std::vector<uint8_t>{3, 1, 2, 3, 3}));
+}
@@ -1,10 +1,12 @@
 #include <cctype>
+#include <fstream>
 
 #include "gtest/gtest.h"
 
 #include "../test_utils.hpp"
 #include "kmer_index/build.hpp"
 #include "kmer_index/load.hpp"
+#include "kmer_index/dump.hpp"
 
 
 using namespace gram;
@@ -232,4 +234,100 @@ TEST(ParseKmerIndex, GivenTwoKmersWithMultipleSearchStates_CorrectKmerIndex) {
             }
     };
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(LoadKmerIndexFile, GivenDumpedKmerIndex_MappedKmerIndexEqual) {
+    Parameters parameters = {};
+    parameters.kmers_size = 4;
+    parameters.kmer_index_fpath = "@kmer_index_fpath";
+
+    KmerIndex kmer_index = {
+            {{2, 2, 2, 2},
+                    SearchStates {
+                            SearchState {
+                                    SA_Interval {1, 1},
+                                    VariantSitePath {
+                                            VariantLocus {42, 43}
+                                    },
+                                    SearchVariantSiteState::within_variant_site
+                            }
+                    }
+            },
+            {{4, 4, 4, 4},
+                    SearchStates {
+                            SearchState {
+                                    SA_Interval {1, 1}
+                            },
+                            SearchState {
+                                    SA_Interval {2, 2},
+                                    VariantSitePath {
+                                            VariantLocus {52, 53},
+                                            VariantLocus {62, 63}
+                                    }
+                            }
+                    }
+            }
+    };
+    kmer_index::dump(kmer_index, parameters);
+
+    auto result = kmer_index::load(parameters);
+    EXPECT_TRUE(result.kmers.is_mapped());
+    EXPECT_TRUE(result.paths.is_mapped());
+    EXPECT_EQ(result, kmer_index);
+}
+
+
+TEST(LoadKmerIndexFile, GivenMappedKmerIndex_BuildingDirectLookupKeepsMapping) {
+    Parameters parameters = {};
+    parameters.kmers_size = 4;
+    parameters.kmer_index_fpath = "@kmer_index_direct_lookup_fpath";
+
+    KmerIndex kmer_index = {
+            {{2, 2, 2, 2}, SearchStates {SearchState {SA_Interval {1, 1}}}},
+            {{4, 1, 3, 2}, SearchStates {SearchState {SA_Interval {2, 3}}}},
+    };
+    kmer_index::dump(kmer_index, parameters);
+
+    auto result = kmer_index::load(parameters);
+    result.build_direct_lookup();
+    EXPECT_TRUE(result.kmers.is_mapped());
+    EXPECT_EQ(result.kmers, kmer_index.kmers);
+}
+
+
+TEST(LoadKmerIndexFile, GivenEmptyKmerIndex_MappedKmerIndexEmpty) {
+    Parameters parameters = {};
+    parameters.kmers_size = 4;
+    parameters.kmer_index_fpath = "@kmer_index_fpath";
+
+    KmerIndex kmer_index = {};
+    kmer_index.kmer_size = 4;
+    kmer_index::dump(kmer_index, parameters);
+
+    auto result = kmer_index::load(parameters);
+    EXPECT_TRUE(result.empty());
+    EXPECT_EQ(result, kmer_index);
+}
+
+
+TEST(LoadKmerIndexFile, GivenKmerCountWrappingByteSize_LoadingExits) {
+    Parameters parameters = {};
+    parameters.kmers_size = 4;
+    parameters.kmer_index_fpath = "@kmer_index_wrapping_count_fpath";
+
+    KmerIndex kmer_index = {
+            {{2, 2, 2, 2}, SearchStates {SearchState {SA_Interval {1, 1}}}},
+    };
+    kmer_index::dump(kmer_index, parameters);
+
+    // The kmers' byte size wraps around to that of a single kmer.
+    std::fstream file(parameters.kmer_index_fpath, std::ios::in | std::ios::out | std::ios::binary);
+    KmerIndexFileHeader header = {};
+    file.read((char *) &header, sizeof(header));
+    header.count_kmers = ((uint64_t) 1 << 61) + 1;
+    file.seekp(0);
+    file.write((const char *) &header, sizeof(header));
+    file.close();
+
+    EXPECT_EXIT(kmer_index::load(parameters), ::testing::ExitedWithCode(1), "");
+}
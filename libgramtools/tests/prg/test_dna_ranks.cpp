@@ -0,0 +1,75 @@
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "../test_utils.hpp"
+
+#include "prg/dna_ranks.hpp"
+
+
+using namespace gram;
+
+
+uint64_t naive_bwt_rank(const uint64_t &upper_index,
+                        const Base &dna_base,
+                        const PRG_Info &prg_info) {
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < upper_index; ++i)
+        count += prg_info.fm_index.bwt[i] == dna_base;
+    return count;
+}
+
+
+TEST(DnaBwtOcc, GivenPrg_RankMatchesBwtCounts) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    for (uint64_t i = 0; i <= prg_info.fm_index.bwt.size(); ++i) {
+        for (Base base = 1; base <= 4; ++base) {
+            auto result = prg_info.dna_bwt_occ.rank(i, base);
+            auto expected = naive_bwt_rank(i, base, prg_info);
+            EXPECT_EQ(result, expected);
+        }
+    }
+}
+
+
+TEST(DnaBwtOcc, PrgSpanningSeveralBlocks_RankMatchesBwtCounts) {
+    std::string prg_raw;
+    for (int i = 0; i < 20; ++i)
+        prg_raw += "acgt5ca6gg5ttac";
+    auto prg_info = generate_prg_info(prg_raw);
+    ASSERT_GT(prg_info.fm_index.bwt.size(), 2 * DNA_BWT_Occ::block_size);
+
+    for (uint64_t i = 0; i <= prg_info.fm_index.bwt.size(); ++i) {
+        for (Base base = 1; base <= 4; ++base) {
+            auto result = prg_info.dna_bwt_occ.rank(i, base);
+            auto expected = naive_bwt_rank(i, base, prg_info);
+            EXPECT_EQ(result, expected);
+        }
+    }
+}
+
+
+TEST(DnaBwtOcc, GivenStoredTable_LoadedTableIdentical) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Parameters parameters = {};
+    parameters.gram_dirpath = "@gram_dir";
+    auto result = load_dna_bwt_occ(parameters);
+    EXPECT_EQ(result, prg_info.dna_bwt_occ);
+}
+
+
+TEST(DnaBwtOcc, GivenTableWithoutFileHeader_LoadingExits) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Parameters parameters = {};
+    parameters.gram_dirpath = "@stale_gram_dir";
+    std::ofstream out(parameters.gram_dirpath + "_dna_bwt_occ", std::ios::binary);
+    prg_info.dna_bwt_occ.serialize(out);
+    out.close();
+
+    EXPECT_EXIT(load_dna_bwt_occ(parameters), ::testing::ExitedWithCode(1), "");
+}
@@ -106,4 +106,19 @@ TEST(GenerateAlleleMask, DoubleDigitMarker_CorrectAlleleMask) {
     };
     for (auto i = 0; i < result.size(); ++i)
         EXPECT_EQ(result[i], expected[i]);
-}
\ No newline at end of file
+}
+
+TEST(GenerateBwtMarkers, GivenPrg_MarkersInBwtOrderIndexedByMaskRank) {
+    const std::string prg_raw = "a5g6t5cc7g8tt8aa7";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto result = generate_bwt_markers(prg_info.fm_index,
+                                       prg_info.bwt_markers_mask,
+                                       prg_info.markers_mask_count_set_bits);
+
+    EXPECT_EQ(result.size(), prg_info.markers_mask_count_set_bits);
+    for (uint64_t i = 0; i < prg_info.fm_index.bwt.size(); ++i) {
+        if (prg_info.bwt_markers_mask[i] == 0)
+            continue;
+        EXPECT_EQ(result[prg_info.bwt_markers_rank(i)], prg_info.fm_index.bwt[i]);
+    }
+}
@@ -70,3 +70,80 @@ TEST(GenerateSitesMask, TwoVariantSites_CorrectSitesMask) {
     sdsl::util::bit_compress(expected);
     EXPECT_EQ(result, expected);
 }
+
+
+TEST(GenerateSitesMarkerInfo, TwoVariantSites_CorrectPrgIndexesAndAlleleCounts) {
+    const std::string prg_raw = "a5g6t5cc7g8tt8aa7";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &result = prg_info.sites_marker_info;
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].start_prg_index, 1);
+    EXPECT_EQ(result[0].end_prg_index, 5);
+    EXPECT_EQ(result[0].count_alleles, 2);
+    EXPECT_EQ(result[1].start_prg_index, 8);
+    EXPECT_EQ(result[1].end_prg_index, 16);
+    EXPECT_EQ(result[1].count_alleles, 3);
+}
+
+
+TEST(GenerateSitesMarkerInfo, TwoVariantSites_SaIndexesMatchSuffixArray) {
+    const std::string prg_raw = "a5g6t5cc7g8tt8aa7";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    for (const auto &site_info: prg_info.sites_marker_info) {
+        EXPECT_EQ(prg_info.fm_index[site_info.start_sa_index], site_info.start_prg_index);
+        EXPECT_EQ(prg_info.fm_index[site_info.end_sa_index], site_info.end_prg_index);
+        EXPECT_EQ(prg_info.fm_index[site_info.sa_right_of_start], site_info.start_prg_index + 1);
+    }
+}
+
+
+TEST(GenerateSitesMarkerInfo, GapInSiteMarkers_SitesAfterGapIndexedByMarker) {
+    const std::string prg_raw = "a5g6t5c9a10t9";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &result = prg_info.sites_marker_info;
+
+    ASSERT_EQ(result.size(), 3);
+    EXPECT_EQ(result[2].start_prg_index, 7);
+    EXPECT_EQ(result[2].end_prg_index, 11);
+    EXPECT_EQ(result[2].count_alleles, 2);
+
+    const auto &site_info = site_marker_info(10, prg_info);
+    EXPECT_EQ(prg_info.fm_index[site_info.start_sa_index], 7);
+    EXPECT_EQ(prg_info.fm_index[site_info.end_sa_index], 11);
+    EXPECT_EQ(prg_info.fm_index[site_info.sa_right_of_start], 8);
+    EXPECT_EQ(prg_info.fm_index[site_info.allele_marker_first_sa_index], 9);
+    EXPECT_EQ(site_info.allele_marker_last_sa_index, site_info.allele_marker_first_sa_index);
+}
+
+
+TEST(Locate, GivenFullSuffixArray_PositionsMatchFmIndex) {
+    const std::string prg_raw = "a5g6t5cc7g8tt8aa7";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    for (uint64_t i = 0; i < prg_info.fm_index.size(); ++i)
+        EXPECT_EQ(locate(i, prg_info), prg_info.fm_index[i]);
+}
+
+
+TEST(Locate, GivenSampledSuffixArray_PositionsMatchFmIndex) {
+    const std::string prg_raw = "ccta5g6t5cc7g8tt8aa7gtacgtt9acg10tgca10t9a";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    for (const uint64_t sampling_interval: {2, 3, 8, 64}) {
+        sample_suffix_array(prg_info, sampling_interval);
+        for (uint64_t i = 0; i < prg_info.fm_index.size(); ++i)
+            EXPECT_EQ(locate(i, prg_info), prg_info.fm_index[i]);
+    }
+}
+
+
+TEST(Locate, GivenSampledSuffixArray_FewerValuesStored) {
+    const std::string prg_raw = "ccta5g6t5cc7g8tt8aa7gtacgtt9acg10tgca10t9a";
+    auto prg_info = generate_prg_info(prg_raw);
+    sample_suffix_array(prg_info, 8);
+
+    auto count_values = prg_info.suffix_array.size() + prg_info.bwt_markers_sa.size() + prg_info.markers_sa.size();
+    EXPECT_LT(count_values, prg_info.fm_index.size());
+}
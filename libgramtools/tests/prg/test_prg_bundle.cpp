@@ -0,0 +1,144 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+#include "../test_utils.hpp"
+
+#include "prg/prg_bundle.hpp"
+
+
+using namespace gram;
+
+
+TEST(PrgInfoBundle, GivenDumpedPrgInfo_LoadedComponentsEqual) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    auto result = load_prg_info_bundle(parameters);
+
+    EXPECT_EQ(result.encoded_prg, prg_info.encoded_prg);
+    EXPECT_EQ(result.sites_mask, prg_info.sites_mask);
+    EXPECT_EQ(result.allele_mask, prg_info.allele_mask);
+    EXPECT_EQ(result.bwt_markers_mask, prg_info.bwt_markers_mask);
+    EXPECT_EQ(result.bwt_markers, prg_info.bwt_markers);
+    EXPECT_EQ(result.prg_markers_mask, prg_info.prg_markers_mask);
+    EXPECT_EQ(result.markers_mask_count_set_bits, prg_info.markers_mask_count_set_bits);
+    EXPECT_EQ(result.max_alphabet_num, prg_info.max_alphabet_num);
+    EXPECT_EQ(result.dna_bwt_occ, prg_info.dna_bwt_occ);
+    EXPECT_EQ(result.suffix_array, prg_info.suffix_array);
+    EXPECT_EQ(result.dna_first_sa_indexes, prg_info.dna_first_sa_indexes);
+    ASSERT_EQ(result.sites_marker_info.size(), prg_info.sites_marker_info.size());
+    for (uint64_t i = 0; i < prg_info.sites_marker_info.size(); ++i) {
+        EXPECT_EQ(result.sites_marker_info[i].start_sa_index, prg_info.sites_marker_info[i].start_sa_index);
+        EXPECT_EQ(result.sites_marker_info[i].sa_right_of_start, prg_info.sites_marker_info[i].sa_right_of_start);
+        EXPECT_EQ(result.sites_marker_info[i].end_prg_index, prg_info.sites_marker_info[i].end_prg_index);
+        EXPECT_EQ(result.sites_marker_info[i].allele_marker_sa_interval(),
+                  prg_info.sites_marker_info[i].allele_marker_sa_interval());
+    }
+}
+
+
+TEST(PrgInfoBundle, GivenLoadedPrgInfo_NoWaveletTreeLoaded) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    auto result = load_prg_info_bundle(parameters);
+    EXPECT_EQ(result.fm_index.size(), 0);
+    EXPECT_EQ(result.suffix_array.size(), prg_info.fm_index.size());
+}
+
+
+TEST(PrgInfoBundle, GivenLoadedPrgInfo_RankAndSelectSupportsUsable) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    auto result = load_prg_info_bundle(parameters);
+
+    for (uint64_t i = 0; i <= prg_info.prg_markers_mask.size(); ++i)
+        EXPECT_EQ(result.prg_markers_rank(i), prg_info.prg_markers_rank(i));
+    for (uint64_t i = 1; i <= prg_info.markers_mask_count_set_bits; ++i)
+        EXPECT_EQ(result.prg_markers_select(i), prg_info.prg_markers_select(i));
+    for (uint64_t i = 0; i <= prg_info.bwt_markers_mask.size(); ++i)
+        EXPECT_EQ(result.bwt_markers_rank(i), prg_info.bwt_markers_rank(i));
+    for (uint64_t i = 1; i <= prg_info.markers_mask_count_set_bits; ++i)
+        EXPECT_EQ(result.bwt_markers_select(i), prg_info.bwt_markers_select(i));
+}
+
+
+TEST(PrgInfoBundle, GivenSampledSuffixArray_LoadedPrgInfoLocatesAllPositions) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    sample_suffix_array(prg_info, 4);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    auto result = load_prg_info_bundle(parameters);
+    EXPECT_EQ(result.sa_sampling_interval, 4);
+    for (uint64_t i = 0; i < prg_info.fm_index.size(); ++i)
+        EXPECT_EQ(locate(i, result), prg_info.fm_index[i]);
+}
+
+
+TEST(PrgInfoBundle, GivenSitesMarkerInfoSizeNotWholeEntries_LoadingExits) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@corrupt_prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    std::ifstream in(parameters.prg_info_bundle_fpath, std::ios::binary);
+    std::string bundle((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // The sites marker info is the last section: find its extent in the header, and shorten it by one byte.
+    const uint64_t size = prg_info.sites_marker_info.size() * sizeof(SiteMarkerInfo);
+    const uint64_t extent[2] = {bundle.size() - size, size};
+    auto extent_position = bundle.find(std::string((const char *) extent, sizeof(extent)));
+    ASSERT_NE(extent_position, std::string::npos);
+    const uint64_t corrupt_size = size - 1;
+    std::memcpy(&bundle[extent_position + sizeof(uint64_t)], &corrupt_size, sizeof(corrupt_size));
+
+    std::ofstream out(parameters.prg_info_bundle_fpath, std::ios::binary | std::ios::trunc);
+    out.write(bundle.data(), bundle.size());
+    out.close();
+
+    EXPECT_EXIT(load_prg_info_bundle(parameters), ::testing::ExitedWithCode(1), "");
+}
+
+
+TEST(PrgInfoBundle, GivenSectionExtentWrappingFileSize_LoadingExits) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.prg_info_bundle_fpath = "@wrapping_prg_info_bundle";
+    dump_prg_info_bundle(prg_info, parameters);
+
+    std::ifstream in(parameters.prg_info_bundle_fpath, std::ios::binary);
+    std::string bundle((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // Move the last section's offset so far that adding its size wraps around to a position inside the file.
+    const uint64_t size = prg_info.sites_marker_info.size() * sizeof(SiteMarkerInfo);
+    const uint64_t extent[2] = {bundle.size() - size, size};
+    auto extent_position = bundle.find(std::string((const char *) extent, sizeof(extent)));
+    ASSERT_NE(extent_position, std::string::npos);
+    const uint64_t wrapping_offset = -size;
+    std::memcpy(&bundle[extent_position], &wrapping_offset, sizeof(wrapping_offset));
+
+    std::ofstream out(parameters.prg_info_bundle_fpath, std::ios::binary | std::ios::trunc);
+    out.write(bundle.data(), bundle.size());
+    out.close();
+
+    EXPECT_EXIT(load_prg_info_bundle(parameters), ::testing::ExitedWithCode(1), "");
+}
@@ -431,3 +431,73 @@ TEST(AlleleStartOffsetIndex, GivenFirstAlleleBase_CorrectAlleleIndexOffset) {
 
     EXPECT_EQ(expected, result);
 }
+
+
+TEST(AlleleBaseCoverage, GivenCoverageShards_CountsAddedPerBase) {
+    Coverage coverage = {};
+    coverage.allele_base_coverage = {{{1, 0}, {2}}, {{0, 0, 1}}};
+    std::vector<Coverage> coverage_shards(2);
+    coverage_shards[0].allele_base_coverage = {{{1, 1}, {0}}, {{3, 0, 0}}};
+    coverage_shards[1].allele_base_coverage = {{{0, 5}, {1}}, {{0, 0, 1}}};
+
+    coverage::merge::allele_base(coverage, coverage_shards);
+    SitesAlleleBaseCoverage expected = {{{2, 6}, {3}}, {{3, 0, 2}}};
+    EXPECT_EQ(coverage.allele_base_coverage, expected);
+}
+
+
+TEST(AlleleBaseCoverage, GivenCoverageShardsAddingPastMaximum_CountSaturates) {
+    Coverage coverage = {};
+    coverage.allele_base_coverage = SitesAlleleBaseCoverage(std::vector<AlleleCoverage> {{{UINT16_MAX - 1, 3}}},
+                                                            BaseCoverageWidth::bits16);
+    std::vector<Coverage> coverage_shards(1);
+    coverage_shards[0].allele_base_coverage = {{{2, 3}}};
+
+    coverage::merge::allele_base(coverage, coverage_shards);
+    SitesAlleleBaseCoverage expected = {{{UINT16_MAX, 6}}};
+    EXPECT_EQ(coverage.allele_base_coverage, expected);
+}
+
+
+TEST(AlleleBaseCoverage, GivenThirtyTwoBitCountersAddingPastSixteenBitMaximum_CountNotSaturated) {
+    Coverage coverage = {};
+    coverage.allele_base_coverage = {{{UINT16_MAX - 1, 3}}};
+    std::vector<Coverage> coverage_shards(1);
+    coverage_shards[0].allele_base_coverage = {{{2, 3}}};
+
+    coverage::merge::allele_base(coverage, coverage_shards);
+    SitesAlleleBaseCoverage expected = {{{UINT16_MAX + 1, 6}}};
+    EXPECT_EQ(coverage.allele_base_coverage, expected);
+}
+
+
+TEST(AlleleBaseCoverage, GivenTwoVariantSites_FlatLayoutGivesAlleleSizes) {
+    auto prg_raw = "ct5gg6aga5ccccc7a8ttt7";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    auto result = coverage::generate::allele_base_structure(prg_info, BaseCoverageWidth::bits16);
+    EXPECT_EQ(result.size(), 2);
+    EXPECT_EQ(result.count_alleles(0), 2);
+    EXPECT_EQ(result.allele_size(0, 1), 3);
+    EXPECT_EQ(result.allele_size(1, 0), 1);
+    EXPECT_EQ(result.width(), BaseCoverageWidth::bits16);
+}
+
+
+TEST(AlleleBaseCoverage, GivenIncrementedBaseRange_OnlyThoseBasesCounted) {
+    SitesAlleleBaseCoverage allele_base_coverage({{2, 3}, {1, 4}}, BaseCoverageWidth::bits32);
+    allele_base_coverage.increment(1, 1, 1, 3);
+    allele_base_coverage.increment(1, 1, 2, 4);
+
+    SitesAlleleBaseCoverage expected = {
+            AlleleCoverage{
+                    BaseCoverage{0, 0},
+                    BaseCoverage{0, 0, 0},
+            },
+            AlleleCoverage{
+                    BaseCoverage{0},
+                    BaseCoverage{0, 1, 2, 1},
+            },
+    };
+    EXPECT_EQ(allele_base_coverage, expected);
+}
@@ -45,4 +45,16 @@ TEST(AlleleSumCoverage, GivenThreeVariantSites_CorrectAlleleSumCoverageStructure
             {0, 0}
     };
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(AlleleSumCoverage, GivenCoverageShards_CountsAddedPerAllele) {
+    Coverage coverage = {};
+    coverage.allele_sum_coverage = {{1, 0}, {0, 2, 0}};
+    std::vector<Coverage> coverage_shards(2);
+    coverage_shards[0].allele_sum_coverage = {{0, 3}, {1, 0, 0}};
+    coverage_shards[1].allele_sum_coverage = {{1, 1}, {0, 0, 4}};
+
+    coverage::merge::allele_sum(coverage, coverage_shards);
+    AlleleSumCoverage expected = {{2, 4}, {1, 2, 4}};
+    EXPECT_EQ(coverage.allele_sum_coverage, expected);
+}
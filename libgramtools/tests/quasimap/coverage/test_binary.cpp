@@ -0,0 +1,184 @@
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "quasimap/coverage/common.hpp"
+#include "quasimap/coverage/binary.hpp"
+
+
+using namespace gram;
+
+
+Coverage make_binary_test_coverage() {
+    Coverage coverage = {};
+    coverage.allele_sum_coverage = {
+            {0, 300},
+            {5, 0, 1ull << 40},
+    };
+    coverage.allele_base_coverage = {
+            AlleleCoverage {
+                    BaseCoverage {0, 0},
+                    BaseCoverage {300, 299, 65535, 0},
+            },
+            AlleleCoverage {
+                    BaseCoverage {5},
+                    BaseCoverage {},
+                    BaseCoverage {1, 2},
+            },
+    };
+    coverage.grouped_allele_counts = {
+            GroupedAlleleCounts {
+                    {AlleleIds {1}, 300},
+            },
+            GroupedAlleleCounts {
+                    {AlleleIds {0, 2}, 1},
+                    {AlleleIds {0}, 4},
+                    {AlleleIds {1}, 2},
+            },
+    };
+    return coverage;
+}
+
+
+TEST(BinaryCoverage, GivenCoverage_ReadAllReturnsSameCoverage) {
+    auto coverage = make_binary_test_coverage();
+    const std::string fpath = "@binary_coverage_round_trip";
+    write_binary_coverage(coverage, fpath);
+
+    BinaryCoverageReader reader(fpath);
+    auto result = reader.read_all();
+    EXPECT_EQ(result.allele_sum_coverage, coverage.allele_sum_coverage);
+    EXPECT_EQ(result.allele_base_coverage, coverage.allele_base_coverage);
+    EXPECT_EQ(result.grouped_allele_counts, coverage.grouped_allele_counts);
+}
+
+
+TEST(BinaryCoverage, GivenSiteIndex_OnlyThatSiteDecoded) {
+    auto coverage = make_binary_test_coverage();
+    const std::string fpath = "@binary_coverage_site";
+    write_binary_coverage(coverage, fpath);
+
+    BinaryCoverageReader reader(fpath);
+    auto result = reader.site(1);
+    EXPECT_EQ(reader.count_sites(), 2);
+    EXPECT_EQ(result.allele_sum_coverage, coverage.allele_sum_coverage[1]);
+    EXPECT_EQ(result.allele_base_coverage, coverage.allele_base_coverage.site(1));
+    EXPECT_EQ(result.grouped_allele_counts, coverage.grouped_allele_counts[1]);
+}
+
+
+TEST(BinaryCoverage, GivenGroupSharedAcrossSites_GroupStoredOnce) {
+    auto coverage = make_binary_test_coverage();
+    const std::string fpath = "@binary_coverage_groups";
+    write_binary_coverage(coverage, fpath);
+
+    BinaryCoverageReader reader(fpath);
+    const auto &result = reader.allele_groups();
+    std::vector<AlleleIds> expected = {
+            AlleleIds {1},
+            AlleleIds {0},
+            AlleleIds {0, 2},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(BinaryCoverage, GivenNoSites_NoSitesRead) {
+    Coverage coverage = {};
+    const std::string fpath = "@binary_coverage_empty";
+    write_binary_coverage(coverage, fpath);
+
+    BinaryCoverageReader reader(fpath);
+    auto result = reader.read_all();
+    EXPECT_EQ(reader.count_sites(), 0);
+    EXPECT_TRUE(result.allele_sum_coverage.empty());
+}
+
+
+TEST(BinaryCoverage, GivenAlleleBaseCoverage_SmallerThanJson) {
+    Coverage coverage = {};
+    coverage.allele_sum_coverage.assign(1000, {100, 100});
+    coverage.allele_base_coverage = SitesAlleleBaseCoverage(
+            std::vector<AlleleCoverage>(1000, AlleleCoverage(2, BaseCoverage(100, 1000))));
+    coverage.grouped_allele_counts.assign(1000, GroupedAlleleCounts {{AlleleIds {0, 1}, 100}});
+    const std::string fpath = "@binary_coverage_size";
+    write_binary_coverage(coverage, fpath);
+
+    std::ifstream file(fpath, std::ios::binary | std::ios::ate);
+    uint64_t result = file.tellg();
+    // Each base of constant coverage takes a single byte, against five characters in JSON.
+    EXPECT_LT(result, 1000 * 2 * 100 + 20000);
+}
+
+
+std::string read_file(const std::string &fpath) {
+    std::ifstream file(fpath, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+Parameters json_coverage_parameters(const std::string &prefix) {
+    Parameters parameters = {};
+    parameters.allele_sum_coverage_fpath = prefix + "_allele_sum_coverage";
+    parameters.allele_base_coverage_fpath = prefix + "_allele_base_coverage.json";
+    parameters.grouped_allele_counts_fpath = prefix + "_grouped_allele_counts_coverage.json";
+    parameters.coverage_format = CoverageFormat::json;
+    parameters.coverage_compression = OutputCompression::none;
+    parameters.maximum_threads = 1;
+    return parameters;
+}
+
+
+TEST(BinaryCoverage, GivenBinaryCoverage_CoverageToJsonMatchesJsonWriter) {
+    auto coverage = make_binary_test_coverage();
+    auto expected_parameters = json_coverage_parameters("@json_writer");
+    coverage::dump::all(coverage, expected_parameters);
+
+    auto parameters = json_coverage_parameters("@coverage_to_json");
+    parameters.binary_coverage_fpath = "@binary_coverage_to_json";
+    write_binary_coverage(coverage, parameters.binary_coverage_fpath);
+    commands::coverage_to_json::run(parameters);
+
+    EXPECT_EQ(read_file(parameters.allele_sum_coverage_fpath),
+              read_file(expected_parameters.allele_sum_coverage_fpath));
+    EXPECT_EQ(read_file(parameters.allele_base_coverage_fpath),
+              read_file(expected_parameters.allele_base_coverage_fpath));
+    EXPECT_EQ(read_file(parameters.grouped_allele_counts_fpath),
+              read_file(expected_parameters.grouped_allele_counts_fpath));
+}
+
+
+TEST(BinaryCoverage, GivenTruncatedFile_ReadingExits) {
+    auto coverage = make_binary_test_coverage();
+    const std::string fpath = "@binary_coverage_truncated";
+    write_binary_coverage(coverage, fpath);
+
+    auto content = read_file(fpath);
+    std::ofstream file(fpath, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), content.size() - sizeof(uint64_t));
+    file.close();
+
+    EXPECT_EXIT(BinaryCoverageReader reader(fpath), ::testing::ExitedWithCode(1), "");
+}
+
+
+TEST(BinaryCoverage, GivenSiteOffsetIntoAlleleGroups_ReadingSiteExits) {
+    auto coverage = make_binary_test_coverage();
+    const std::string fpath = "@binary_coverage_corrupt";
+    write_binary_coverage(coverage, fpath);
+
+    // Point the end of the last site record past the allele groups, at the start of the index.
+    auto content = read_file(fpath);
+    uint64_t index_offset;
+    std::memcpy(&index_offset, content.data() + sizeof(binary_coverage_magic) + 4 * sizeof(uint64_t),
+                sizeof(index_offset));
+    std::memcpy(&content[index_offset + 2 * sizeof(uint64_t)], &index_offset, sizeof(index_offset));
+    std::ofstream file(fpath, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), content.size());
+    file.close();
+
+    BinaryCoverageReader reader(fpath);
+    EXPECT_EXIT(reader.site(1), ::testing::ExitedWithCode(1), "");
+}
@@ -1,4 +1,5 @@
 #include <cctype>
+#include <unordered_set>
 #include "gtest/gtest.h"
 
 #include "../../test_utils.hpp"
@@ -130,22 +131,62 @@ TEST(CheckAlleleEncapsulated, MappingExtendsOneBaseLeftOustideOfSite_False) {
 }
 
 
-TEST(RrandomIntInclusive, RandomCall_MinBoundaryReturned) {
-    uint64_t random_seed = 48;
-    uint64_t result = random_int_inclusive(1, 10, random_seed);
-    uint64_t expected = 1;
+TEST(RrandomIntInclusive, ManyCalls_AllValuesWithinBoundsAndBoundariesReturned) {
+    RandomGenerator random_generator(42, 0);
+    std::unordered_set<uint64_t> results;
+    for (int i = 0; i < 1000; ++i) {
+        uint64_t result = random_int_inclusive(1, 10, random_generator);
+        EXPECT_TRUE(result >= 1 and result <= 10);
+        results.insert(result);
+    }
+    EXPECT_EQ(results.count(1), 1);
+    EXPECT_EQ(results.count(10), 1);
+}
+
+
+TEST(RrandomIntInclusive, SingleValueRange_ValueReturned) {
+    RandomGenerator random_generator(42, 0);
+    uint64_t result = random_int_inclusive(7, 7, random_generator);
+    uint64_t expected = 7;
     EXPECT_EQ(result, expected);
 }
 
 
-TEST(RrandomIntInclusive, RandomCall_MaxBoundaryReturned) {
-    uint64_t random_seed = 56;
-    uint64_t result = random_int_inclusive(1, 10, random_seed);
-    uint64_t expected = 10;
+TEST(RandomGenerator, SameSeedAndStream_SameDraws) {
+    RandomGenerator first_generator(42, 3);
+    RandomGenerator second_generator(42, 3);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(first_generator.next(), second_generator.next());
+}
+
+
+TEST(RandomGenerator, ConsecutiveStreams_DifferentDraws) {
+    RandomGenerator first_generator(42, 3);
+    RandomGenerator second_generator(42, 4);
+    EXPECT_NE(first_generator.next(), second_generator.next());
+}
+
+
+TEST(RandomGenerator, DifferentSeeds_DifferentDraws) {
+    RandomGenerator first_generator(42, 3);
+    RandomGenerator second_generator(43, 3);
+    EXPECT_NE(first_generator.next(), second_generator.next());
+}
+
+
+TEST(ResolveRandomSeed, GivenNonZeroSeed_SeedReturned) {
+    uint32_t result = resolve_random_seed(42);
+    uint32_t expected = 42;
     EXPECT_EQ(result, expected);
 }
 
 
+TEST(ResolveRandomSeed, GivenZeroSeed_NonZeroSeedReturned) {
+    uint32_t result = resolve_random_seed(0);
+    EXPECT_NE(result, 0);
+}
+
+
 TEST(CountNonvariantSearchStates, OnePathOneNonPath_CountOne) {
     SearchStates search_states = {
             SearchState {
@@ -306,4 +347,21 @@ TEST(FilterForPathSites, TwoSearchStatesDifferentPaths_CorrectEmptySearchStates)
     auto result = filter_for_path_sites(target_path, search_states);
     SearchStates expected = {};
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(MergeCoverage, GivenSeveralCoverageShards_AllCoverageTypesAdded) {
+    auto prg_raw = "gcgct5gg6agtg5ctgt";
+    auto prg_info = generate_prg_info(prg_raw);
+    std::vector<Coverage> coverage_shards(3, coverage::generate::empty_structure(prg_info));
+    coverage_shards[0].allele_sum_coverage = {{1, 0}};
+    coverage_shards[0].allele_base_coverage = {{{1, 1}, {0, 0, 0, 0}}};
+    coverage_shards[0].grouped_allele_counts = {{{AlleleIds{0}, 1}}};
+    coverage_shards[2].allele_sum_coverage = {{1, 1}};
+    coverage_shards[2].allele_base_coverage = {{{0, 1}, {1, 1, 0, 0}}};
+    coverage_shards[2].grouped_allele_counts = {{{AlleleIds{0}, 1}, {AlleleIds{1}, 1}}};
+
+    auto result = coverage::merge::all(coverage_shards);
+    EXPECT_EQ(result.allele_sum_coverage, (AlleleSumCoverage{{2, 1}}));
+    EXPECT_EQ(result.allele_base_coverage, (SitesAlleleBaseCoverage{{{1, 2}, {1, 1, 0, 0}}}));
+    EXPECT_EQ(result.grouped_allele_counts, (SitesGroupedAlleleCounts{{{AlleleIds{0}, 2}, {AlleleIds{1}, 1}}}));
+}
@@ -1,10 +1,13 @@
 #include <cctype>
+#include <fstream>
+#include <omp.h>
 
 #include "gtest/gtest.h"
 
 #include "../test_utils.hpp"
 #include "kmer_index/build.hpp"
 #include "quasimap/coverage/common.hpp"
+#include "quasimap/coverage/grouped_allele_counts.hpp"
 #include "quasimap/quasimap.hpp"
 #include "common/utils.hpp"
 
@@ -248,8 +251,8 @@ TEST(Quasimap, ReadMapsToThreePositions_CorrectAlleleCoverage) {
 
     const auto &result = coverage.allele_sum_coverage;
     AlleleSumCoverage expected = {
-            {1, 0, 1},
-            {0, 0}
+            {0, 0, 1},
+            {1, 0}
     };
     EXPECT_EQ(result, expected);
 }
@@ -618,9 +621,62 @@ TEST(Quasimap, MappingThreeReadsOneReadMappsTwice_CorrectAlleleCoverage) {
 
     const auto &result = coverage.allele_sum_coverage;
     AlleleSumCoverage expected = {
-            {1, 0, 1},
-            {0, 0}
+            {1, 0, 0},
+            {0, 1}
     };
     EXPECT_EQ(result, expected);
 }
 
+
+
+Coverage quasimap_reads_file(const std::string &reads_fpath,
+                             const uint64_t &count_threads,
+                             const uint64_t &reads_batch_size,
+                             const KmerIndex &kmer_index,
+                             const PRG_Info &prg_info,
+                             const Parameters &parameters) {
+    auto thread_parameters = parameters;
+    thread_parameters.reads_batch_size = reads_batch_size;
+
+    omp_set_num_threads((int) count_threads);
+    std::vector<Coverage> coverage_shards;
+    for (uint64_t i = 0; i < count_threads; ++i)
+        coverage_shards.emplace_back(coverage::generate::empty_structure(prg_info));
+    QuasimapReadsStats quasimap_stats = {};
+    ReadStats readstats;
+    handle_read_file(quasimap_stats, coverage_shards, readstats, reads_fpath, thread_parameters, kmer_index, prg_info);
+    return coverage::merge::all(std::move(coverage_shards));
+}
+
+
+TEST(Quasimap, GivenDifferentThreadCountsAndBatchSizes_IdenticalCoverage) {
+    auto prg_raw = "gcac5t6g6c5ta7t8c7cta";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Patterns kmers = {
+            encode_dna_bases("cta"),
+            encode_dna_bases("act"),
+    };
+    Parameters parameters = {};
+    parameters.kmers_size = 3;
+    parameters.seed = 42;
+    parameters.reads_queue_depth = 2;
+    auto kmer_index = index_kmers(kmers, parameters.kmers_size, prg_info);
+
+    const std::string reads_fpath = "@quasimap_deterministic_reads.fa";
+    {
+        std::ofstream reads_file(reads_fpath);
+        for (int i = 0; i < 200; ++i)
+            reads_file << ">read" << i << "\n" << (i % 2 == 0 ? "ACCTA" : "GCACT") << "\n";
+    }
+
+    auto max_threads = (uint64_t) omp_get_max_threads();
+    auto expected = quasimap_reads_file(reads_fpath, 1, 1000, kmer_index, prg_info, parameters);
+    auto result = quasimap_reads_file(reads_fpath, 4, 7, kmer_index, prg_info, parameters);
+    omp_set_num_threads((int) max_threads);
+
+    EXPECT_EQ(result.allele_sum_coverage, expected.allele_sum_coverage);
+    EXPECT_EQ(result.allele_base_coverage, expected.allele_base_coverage);
+    EXPECT_EQ(dump_grouped_allele_counts(result.grouped_allele_counts),
+              dump_grouped_allele_counts(expected.grouped_allele_counts));
+}
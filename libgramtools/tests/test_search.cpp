@@ -279,6 +279,40 @@ TEST(MarkerSearch, GivenCharG_ReturnOneCorrectSearchResults) {
 }
 
 
+TEST(MarkerSearch, GivenIntervalWithoutMarkers_NoSearchResults) {
+    auto prg_raw = "gcgct5c6g6a5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    // first char: t
+    SearchState initial_search_state = {
+            SA_Interval {12, 14}
+    };
+
+    auto result = left_markers_search(initial_search_state,
+                                      prg_info);
+    MarkersSearchResults expected = {};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(MarkerSearch, GivenWholeSuffixArray_AllMarkersFound) {
+    auto prg_raw = "gcgct5c6g6a5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    SearchState initial_search_state = {
+            SA_Interval {0, prg_info.fm_index.size() - 1}
+    };
+
+    auto result = left_markers_search(initial_search_state,
+                                      prg_info);
+    MarkersSearchResults expected;
+    for (uint64_t i = 0; i < prg_info.fm_index.size(); ++i) {
+        if (prg_info.fm_index.bwt[i] > 4)
+            expected.emplace_back(i, prg_info.fm_index.bwt[i]);
+    }
+    EXPECT_EQ(result.size(), 4);
+    EXPECT_EQ(result, expected);
+}
+
+
 TEST(Search, SingleCharAllele_CorrectSkipToSiteStartBoundaryMarker) {
     auto prg_raw = "gcgct5c6g6a5agtcct";
     auto prg_info = generate_prg_info(prg_raw);
@@ -645,6 +679,28 @@ TEST(Search, InitialStateWithPopulatedVariantSitePath_CorrectVariantSitePathInRe
 }
 
 
+TEST(Search, ConsumedSearchStates_SameResultAsCopiedSearchStates) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto pattern_char = encode_dna_base('t');
+
+    SearchState initial_search_state = {
+            SA_Interval {10, 10},
+            VariantSitePath {},
+            SearchVariantSiteState::unknown,
+    };
+    SearchStates initial_search_states = {initial_search_state};
+
+    auto expected = process_read_char_search_states(pattern_char,
+                                                    initial_search_states,
+                                                    prg_info);
+    auto result = process_read_char_search_states(pattern_char,
+                                                  std::move(initial_search_states),
+                                                  prg_info);
+    EXPECT_EQ(result, expected);
+}
+
+
 TEST(Search, KmerAbsentFromKmerIndex_NoSearchStatesReturned) {
     auto prg_raw = "gcgct5c6g6t5agtcct";
     auto prg_info = generate_prg_info(prg_raw);
@@ -20,6 +20,8 @@ PRG_Info generate_prg_info(const std::string &prg_raw) {
 
     PRG_Info prg_info;
     prg_info.fm_index = generate_fm_index(parameters);
+    sample_suffix_array(prg_info, 1);
+    prg_info.dna_first_sa_indexes = generate_dna_first_sa_indexes(prg_info.fm_index);
     prg_info.encoded_prg = encoded_prg;
     prg_info.sites_mask = generate_sites_mask(encoded_prg);
     prg_info.allele_mask = generate_allele_mask(encoded_prg);
@@ -32,14 +34,14 @@ PRG_Info generate_prg_info(const std::string &prg_raw) {
             prg_info.prg_markers_rank(prg_info.prg_markers_mask.size());
 
     prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
+    prg_info.bwt_markers = generate_bwt_markers(prg_info.fm_index,
+                                                prg_info.bwt_markers_mask,
+                                                prg_info.markers_mask_count_set_bits);
 
-    generate_dna_bwt_masks(prg_info.fm_index, parameters);
-    prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index,
-                                                parameters);
-    prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-    prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-    prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-    prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+    prg_info.dna_bwt_occ = generate_dna_bwt_occ(prg_info.fm_index, parameters);
+    prg_info.sites_marker_info = generate_sites_marker_info(prg_info.fm_index);
 
     prg_info.max_alphabet_num = get_max_alphabet_num(encoded_prg);
     return prg_info;
@@ -52,3 +54,14 @@ TEST(ReverseComplimentRead, GivenRead_ReverseComplimnetReadReturned) {
     Pattern expected = {1, 2, 4, 3, 4};
     EXPECT_EQ(result, expected);
 }
+
+
+void sample_suffix_array(PRG_Info &prg_info, const uint64_t &sampling_interval) {
+    auto sa_samples = generate_suffix_array_samples(prg_info.fm_index, sampling_interval);
+    prg_info.sa_sampling_interval = sampling_interval;
+    prg_info.suffix_array = std::move(sa_samples.suffix_array);
+    prg_info.sa_samples_mask = std::move(sa_samples.sa_samples_mask);
+    prg_info.sa_samples_rank = sdsl::rank_support_v<1>(&prg_info.sa_samples_mask);
+    prg_info.bwt_markers_sa = std::move(sa_samples.bwt_markers_sa);
+    prg_info.markers_sa = std::move(sa_samples.markers_sa);
+}
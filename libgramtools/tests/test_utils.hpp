@@ -6,4 +6,9 @@
 
 gram::PRG_Info generate_prg_info(const std::string &prg_raw);
 
+/**
+ * Replaces the suffix array of `prg_info` with one sampled every `sampling_interval` prg positions.
+ */
+void sample_suffix_array(gram::PRG_Info &prg_info, const uint64_t &sampling_interval);
+
 #endif //GRAMTOOLS_TEST_UTILS_HPP